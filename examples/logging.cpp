@@ -3,6 +3,8 @@
 //
 
 #include "event_dispatcher.h"
+#include "event_policy.h"
+#include <functional>
 #include <iostream>
 #include <string>
 
@@ -55,6 +57,36 @@ auto main(int argc, char *argv[]) -> int {
   event_dispatcher.Dispatch<LogEvent>(
       {LogEvent::LogLevel::ERROR, "Dispatched error message"});
 
+  std::cout << "\n** Error Storm Example **\n\n";
+
+  // Replica 0 fails on every other attempt while the others fail in turn.
+  // Repeats of a waiting message are coalesced, a batch is delivered once 10
+  // distinct messages are waiting, and at most 20 errors are let through per
+  // burst
+  event_dispatcher.SetPolicy<const LogEvent &>(
+      {.coalesce_key =
+           [](const LogEvent &event) {
+             return std::hash<std::string>{}(event.message);
+           },
+       .batch_size = 10,
+       .max_events_per_second = 1,
+       .burst_size = 20});
+  event_dispatcher.AddCallback<const LogEvent &>(OnLogEvent);
+
+  for (int i = 0; i < 100; ++i) {
+    int replica = i % 2 == 0 ? 0 : 1 + (i / 2) % 12;
+    event_dispatcher.Dispatch<const LogEvent &>(
+        {LogEvent::LogLevel::ERROR,
+         "Connection lost to replica " + std::to_string(replica)});
+  }
+  // Delivers the last batch, which is not full
+  event_dispatcher.FlushEvents<const LogEvent &>();
+
+  auto stats = event_dispatcher.GetPolicyStats<const LogEvent &>();
+  std::cout << "Received " << stats.received << " errors, delivered "
+            << stats.delivered << ", coalesced " << stats.coalesced
+            << ", rate limited " << stats.rate_limited << "\n";
+
   event_dispatcher.RemoveCallback<LogEvent>(callback_id);
 
   return 0;
@@ -5,16 +5,73 @@
 #pragma once
 
 #include "event_handler.h"
-#include <algorithm>
-#include <iostream>
-#include <memory>
+#include "event_system_fwd.h"
 #include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
 #include <typeindex>
 #include <typeinfo>
 #include <unordered_map>
 
+#ifdef EVENT_SYSTEM_ENABLE_TRACING
+#include "event_tracer.h"
+#endif
+
 namespace event_system {
 
+/**
+ * @struct ParallelDispatchOptions
+ * @brief Controls when the callbacks of an event type are run in parallel.
+ *
+ * Handlers with fewer than min_callbacks callbacks are still called serially,
+ * since waking up the thread pool costs more than running a few cheap
+ * callbacks. Use the EventDispatcher_ParallelFanOut benchmark to find the
+ * crossover point for your callbacks.
+ */
+struct ParallelDispatchOptions {
+  // Minimum amount of callbacks needed to dispatch in parallel
+  size_t min_callbacks = 8;
+  // Amount of callbacks run serially by each task, raise it for cheap
+  // callbacks
+  size_t callbacks_per_task = 1;
+};
+
+/**
+ * @class IEventPolicyFilter
+ * @brief Interface for all event policy filters
+ *
+ * Allows filters for different event types to be stored in a single
+ * container.
+ *
+ * @note Should not be inherited from directly, instead use EventPolicyFilter
+ */
+class IEventPolicyFilter {
+public:
+  virtual ~IEventPolicyFilter() = default;
+};
+
+/**
+ * @class ITypedEventPolicyFilter
+ * @brief Interface through which Dispatch applies the policy of an event type.
+ * @tparam Args The event type the policy applies to.
+ *
+ * Lets Dispatch apply policies without including event_policy.h.
+ *
+ * @note Should not be inherited from directly, instead use EventPolicyFilter
+ */
+template <typename... Args>
+class ITypedEventPolicyFilter : public IEventPolicyFilter {
+public:
+  /**
+   * @brief Applies the policy to an event, delivering it if it passes.
+   * @param dispatcher The dispatcher that owns the filter.
+   * @param args The event to be dispatched.
+   */
+  virtual void Dispatch(EventDispatcher &dispatcher, Args... args) = 0;
+};
+
 /**
  * @brief Provides a method of communication between independent application
  * components through events
@@ -24,11 +81,18 @@ namespace event_system {
  * of that type are being triggered through the application. It instantiates an
  * new EventHandler for each event type that needs to be listened to and passes
  * along the registered callbacks to said handler.
+ *
+ * The dispatcher is meant to be used from a single thread. The only exception
+ * is the timer thread, see StartTimerThread.
+ *
+ * Only what is needed to add callbacks and dispatch events is defined here.
+ * Include event_policy.h to use policies and event_timers.h to use delayed
+ * and periodic events.
  */
 class EventDispatcher {
 public:
-  EventDispatcher() = default;
-  ~EventDispatcher() = default;
+  EventDispatcher();
+  ~EventDispatcher();
 
   /**
    * @brief Adds a callback for the specified event type.
@@ -45,6 +109,7 @@ public:
    */
   template <typename... Args, typename Function>
   size_t AddCallback(Function &&callback) {
+    TimerThreadGuard guard{*this};
     return GetOrCreateHandler<Args...>().AddCallback(
         std::forward<Function>(callback));
   }
@@ -54,43 +119,165 @@ public:
    * @tparam Args The event type the callback is registered for.
    * @param callback_id Identifier of the callback to remove.
    */
-  template <typename... Args> void RemoveCallback(size_t callback_id) {
-    auto handler = GetHandler<Args...>();
-    if (!handler) {
-      return;
-    }
-
-    handler->RemoveCallback(callback_id);
-
-    if (handler->GetCallbackCount() == 0) {
-      ClearHandlerCallbacks<Args...>();
-    }
-  }
+  template <typename... Args> void RemoveCallback(size_t callback_id);
 
   /**
    * @brief Removes all callbacks for the specified event type.
    * @tparam Args The event type for which callbacks will be removed.
    */
-  template <typename... Args> void ClearHandlerCallbacks() {
-    handlers_.erase(std::type_index(typeid(EventHandler<Args...>)));
-  }
+  template <typename... Args> void ClearHandlerCallbacks();
 
   /**
    * @brief Dispatches an event to the appropriate EventHandler.
    * @tparam Args The type of the event to be dispatched.
    * @param event The event to be dispatched.
    */
-  template <typename... Args> void Dispatch(Args... args) {
-    // TODO: Cache the handler to avoid multiple lookups
-    auto handler = GetHandler<Args...>();
-    if (!handler) {
-      std::clog << "No handler for event type: "
-                << typeid(EventHandler<Args...>).name() << std::endl;
-      return;
-    }
-    handler->OnEvent(args...);
+  template <typename... Args> void Dispatch(Args... args);
+
+  /**
+   * @brief Sets the coalescing, batching and rate limiting policy for the
+   * specified event type, replacing any previous one.
+   * @tparam Args The event type the policy applies to.
+   * @param policy The policy to apply before events reach the callbacks.
+   *
+   * @note Events buffered under a previous policy are flushed first.
+   * @note Policy functions are defined in event_policy.h.
+   * @throws std::invalid_argument If coalesce_key is set without batch_size
+   * or flush_interval.
+   */
+  template <typename... Args> void SetPolicy(EventPolicy<Args...> policy);
+
+  /**
+   * @brief Removes the policy for the specified event type. Buffered events
+   * are flushed.
+   * @tparam Args The event type the policy applies to.
+   */
+  template <typename... Args> void ClearPolicy();
+
+  /**
+   * @brief Delivers all buffered events of the specified event type to its
+   * callbacks.
+   * @tparam Args The event type to flush.
+   */
+  template <typename... Args> void FlushEvents();
+
+  /**
+   * @brief Returns the policy counters for the specified event type.
+   * @tparam Args The event type the policy applies to.
+   * @return EventPolicyStats Counters of received, delivered and suppressed
+   * events. Empty if the event type has no policy.
+   */
+  template <typename... Args> [[nodiscard]] EventPolicyStats GetPolicyStats();
+
+  /**
+   * @brief Runs the callbacks of the specified event type in parallel on the
+   * dispatcher thread pool. Dispatch still returns only once every callback
+   * has finished.
+   * @tparam Args The event type to dispatch in parallel.
+   * @param options Thresholds below which events are dispatched serially.
+   *
+   * @note The thread pool is started the first time this is called, with one
+   * worker less than the amount of hardware threads since the dispatching
+   * thread takes part in the work.
+   * @note Callbacks dispatched in parallel must never call into the
+   * dispatcher, not even from the dispatching thread. Doing so throws
+   * std::logic_error, which is rethrown from Dispatch once every callback has
+   * finished.
+   */
+  template <typename... Args>
+  void SetParallelDispatch(ParallelDispatchOptions options = {}) {
+    TimerThreadGuard guard{*this};
+    GetThreadPool();
+    parallel_options_[std::type_index(typeid(EventHandler<Args...>))] = options;
   }
 
+  /**
+   * @brief Goes back to calling the callbacks of the specified event type
+   * serially.
+   * @tparam Args The event type to dispatch serially.
+   */
+  template <typename... Args> void ClearParallelDispatch() {
+    TimerThreadGuard guard{*this};
+    parallel_options_.erase(std::type_index(typeid(EventHandler<Args...>)));
+  }
+
+  /**
+   * @brief Dispatches an event once the given delay has elapsed.
+   * @tparam Args The type of the event to be dispatched.
+   * @param delay Time to wait before dispatching the event.
+   * @param args The event to be dispatched.
+   * @returns TimerId Identifier that can be used to cancel the timer.
+   *
+   * @note Arguments are copied and kept alive until the event is dispatched,
+   * reference types receive a reference to that copy.
+   * @note Delays are measured from the time of the call and rounded up to
+   * whole timer ticks, events are never dispatched early.
+   * @note Timer functions taking a duration or time point are defined in
+   * event_timers.h.
+   */
+  template <typename... Args, typename Duration>
+  TimerId DispatchAfter(Duration delay, Args... args);
+
+  /**
+   * @brief Dispatches an event periodically until the timer is cancelled.
+   * @tparam Args The type of the event to be dispatched.
+   * @param period Time between dispatches. The first dispatch happens after a
+   * full period.
+   * @param args The event to be dispatched.
+   * @returns TimerId Identifier that can be used to cancel the timer.
+   */
+  template <typename... Args, typename Duration>
+  TimerId DispatchEvery(Duration period, Args... args);
+
+  /**
+   * @brief Cancels a delayed or periodic event.
+   * @param timer_id Identifier returned by DispatchAfter or DispatchEvery.
+   * @returns bool True if the timer was pending and has been cancelled.
+   */
+  bool CancelTimer(TimerId timer_id);
+
+  /**
+   * @brief Dispatches every delayed event that is due now.
+   * @returns size_t The amount of events that were dispatched.
+   *
+   * @note Should not be called while the timer thread is running.
+   */
+  size_t Tick();
+
+  /**
+   * @brief Dispatches every delayed event that is due at the given time.
+   * @param now Current time, a TimerClock::time_point.
+   * @returns size_t The amount of events that were dispatched.
+   *
+   * @note Should not be called while the timer thread is running.
+   */
+  template <typename TimePoint> size_t Tick(TimePoint now);
+
+  /**
+   * @brief Starts a background thread that calls Tick once per timer
+   * resolution.
+   *
+   * While the thread runs, every dispatcher call takes a lock shared with the
+   * timer thread, so the dispatcher can still be used from the thread that
+   * owns it. Other threads must not use the dispatcher.
+   *
+   * @note Delayed events are dispatched from the timer thread, state shared
+   * between callbacks and the rest of the application must be synchronized
+   * by the callbacks.
+   */
+  void StartTimerThread();
+
+  /**
+   * @brief Stops the background timer thread, if running.
+   */
+  void StopTimerThread();
+
+  /**
+   * @brief Returns the amount of delayed events waiting to be dispatched.
+   * @return size_t The amount of pending timers
+   */
+  [[nodiscard]] size_t GetPendingTimerCount() const;
+
   /**
    * @brief Returns the amount of active event handlers.
    * @return size_t The amount of active handlers
@@ -98,6 +285,45 @@ public:
   [[nodiscard]] size_t GetHandlerCount() const;
 
 private:
+  /**
+   * @class TimerThreadGuard
+   * @brief Serializes a dispatcher call with the timer thread.
+   *
+   * Only locks while the timer thread is running, so single threaded use pays
+   * no locking cost. The lock is recursive since callbacks may call back into
+   * the dispatcher.
+   *
+   * Calls made from callbacks dispatched in parallel are rejected before
+   * locking, since the dispatching thread already holds the lock.
+   */
+  class TimerThreadGuard {
+  public:
+    explicit TimerThreadGuard(const EventDispatcher &dispatcher)
+        : dispatcher_(dispatcher), locked_(dispatcher.LockTimerState()) {}
+
+    ~TimerThreadGuard() {
+      if (locked_) {
+        dispatcher_.UnlockTimerState();
+      }
+    }
+
+    TimerThreadGuard(const TimerThreadGuard &) = delete;
+    TimerThreadGuard &operator=(const TimerThreadGuard &) = delete;
+
+  private:
+    const EventDispatcher &dispatcher_;
+    bool locked_;
+  };
+
+  /**
+   * @brief Locks the timer state if the timer thread is running.
+   * @returns bool True if the timer state was locked.
+   * @throws std::logic_error If called from a callback dispatched in
+   * parallel, see SetParallelDispatch.
+   */
+  [[nodiscard]] bool LockTimerState() const;
+  void UnlockTimerState() const;
+
   /**
    * @brief Returns a reference to the EventHandler for the specified event
    * type. Creates a new handler if one does not exist.
@@ -106,15 +332,15 @@ private:
    */
   template <typename... Args>
   [[nodiscard]] EventHandler<Args...> &GetOrCreateHandler() {
-    std::type_index type_index{typeid(EventHandler<Args...>)};
-    auto it = handlers_.find(type_index);
-    if (it == handlers_.end()) {
-      auto handler = std::make_unique<EventHandler<Args...>>();
-      it = handlers_.emplace(type_index, std::move(handler)).first;
+    const std::type_info &handler_type = typeid(EventHandler<Args...>);
+    IEventHandler *handler = FindHandler(handler_type);
+    if (!handler) {
+      handler = &AddHandler(handler_type,
+                            std::make_unique<EventHandler<Args...>>());
     }
     // Return a reference instead of a pointer since the handler is guaranteed
     // to exist
-    return static_cast<EventHandler<Args...>&>(*it->second);
+    return static_cast<EventHandler<Args...> &>(*handler);
   }
 
   /**
@@ -124,15 +350,210 @@ private:
    */
   template <typename... Args>
   [[nodiscard]] EventHandler<Args...>* GetHandler() {
-    auto it = handlers_.find(std::type_index(typeid(EventHandler<Args...>)));
-    if (it != handlers_.end()) {
-      return static_cast<EventHandler<Args...> *>(it->second.get());
+    return static_cast<EventHandler<Args...> *>(
+        FindHandler(typeid(EventHandler<Args...>)));
+  }
+
+  /**
+   * @brief Returns a pointer to the policy filter for the specified event
+   * type.
+   * @tparam Args The event type of the policy.
+   * @returns EventPolicyFilter<Args...>* Pointer to the filter, nullptr if the
+   * event type has no policy.
+   *
+   * @note Defined in event_policy.h.
+   */
+  template <typename... Args>
+  [[nodiscard]] EventPolicyFilter<Args...> *GetPolicy();
+
+  // Handler and policy maps are only accessed through these, so their
+  // members are instantiated once in the library instead of in every
+  // translation unit. Policies and parallel options are keyed by handler
+  // type, setting a null policy removes it
+
+  [[nodiscard]] IEventHandler *FindHandler(const std::type_info &handler_type);
+  IEventHandler &AddHandler(const std::type_info &handler_type,
+                            std::unique_ptr<IEventHandler> handler);
+  void EraseHandler(const std::type_info &handler_type);
+  [[nodiscard]] IEventPolicyFilter *
+  FindPolicy(const std::type_info &handler_type);
+  void SetPolicyFilter(const std::type_info &handler_type,
+                       std::unique_ptr<IEventPolicyFilter> policy);
+  [[nodiscard]] const ParallelDispatchOptions *
+  FindParallelOptions(const std::type_info &handler_type) const;
+
+  /**
+   * @brief Passes an event to the EventHandler of its type.
+   * @tparam Args The type of the event to be delivered.
+   * @param args The event to be delivered.
+   */
+  template <typename... Args> void DeliverEvent(Args... args) {
+    // TODO: Cache the handler to avoid multiple lookups
+    auto handler = GetHandler<Args...>();
+    if (!handler) {
+      LogMissingHandler(typeid(EventHandler<Args...>));
+      return;
+    }
+
+    if (!parallel_options_.empty()) {
+      auto options = FindParallelOptions(typeid(EventHandler<Args...>));
+      if (options && handler->GetCallbackCount() >= options->min_callbacks) {
+        handler->OnEventParallel(GetThreadPool(), options->callbacks_per_task,
+                                 args...);
+        return;
+      }
     }
-    return nullptr;
+    handler->OnEvent(args...);
+  }
+
+  /**
+   * @brief Applies the policy of an event type before delivering the event.
+   * @tparam Args The type of the event to be dispatched.
+   * @param policy The filter holding the policy state of the event type.
+   * @param args The event to be dispatched.
+   */
+  template <typename... Args>
+  void DispatchWithPolicy(EventPolicyFilter<Args...> &policy, Args... args);
+
+  /**
+   * @brief Schedules a timer that dispatches a copy of the given event.
+   * @tparam Args The type of the event to be dispatched.
+   * @param delay Ticks of TimerClock to wait before the first dispatch.
+   * @param period Ticks of TimerClock between dispatches, zero for a single
+   * dispatch.
+   * @param args The event to be dispatched.
+   * @returns TimerId Identifier of the timer.
+   */
+  template <typename... Args>
+  TimerId ScheduleDispatch(int64_t delay, int64_t period, Args... args) {
+    return ScheduleTask(
+        delay, period, [this, ... event_args = std::move(args)]() mutable {
+          Dispatch<Args...>(event_args...);
+        });
   }
 
+  // Durations and time points are passed as ticks of TimerClock, so this
+  // header does not need <chrono>
+
+  /**
+   * @brief Schedules a task on the dispatcher timers.
+   * @param delay Ticks of TimerClock to wait before the first run.
+   * @param period Ticks of TimerClock between runs, zero for a single run.
+   * @param task Function to be run once the timer expires.
+   * @returns TimerId Identifier of the timer.
+   */
+  TimerId ScheduleTask(int64_t delay, int64_t period,
+                       std::function<void()> task);
+
+  /**
+   * @brief Runs every timer that is due at the given time.
+   * @param now Ticks of TimerClock since its epoch.
+   * @returns size_t The amount of timers that were run.
+   */
+  size_t TickTimers(int64_t now);
+
+  /**
+   * @brief Returns the thread pool used for parallel dispatch, starting it if
+   * needed.
+   */
+  ThreadPool &GetThreadPool();
+
+  /**
+   * @brief Reports a dispatched event that has no handler.
+   * @param handler_type Type of the missing EventHandler.
+   */
+  static void LogMissingHandler(const std::type_info &handler_type);
+
 private:
   std::unordered_map<std::type_index, std::unique_ptr<IEventHandler>> handlers_;
+  std::unordered_map<std::type_index, std::unique_ptr<IEventPolicyFilter>>
+      policies_;
+
+  struct TimerState;
+  // Timer wheel and timer thread, kept out of this header to avoid pulling
+  // <chrono>, <thread> and <mutex> into every translation unit
+  std::unique_ptr<TimerState> timer_state_;
+
+  std::unordered_map<std::type_index, ParallelDispatchOptions> parallel_options_;
+  std::unique_ptr<ThreadPool> thread_pool_;
+
+  template <typename... Args> friend class EventPolicyFilter;
 };
 
+// Defined out of class so explicit instantiation declarations prevent them
+// from being instantiated in every translation unit, see
+// EVENT_SYSTEM_EXTERN_EVENT
+
+template <typename... Args>
+void EventDispatcher::RemoveCallback(size_t callback_id) {
+  TimerThreadGuard guard{*this};
+  auto handler = GetHandler<Args...>();
+  if (!handler) {
+    return;
+  }
+
+  handler->RemoveCallback(callback_id);
+
+  if (handler->GetCallbackCount() == 0) {
+    ClearHandlerCallbacks<Args...>();
+  }
+}
+
+template <typename... Args> void EventDispatcher::ClearHandlerCallbacks() {
+  TimerThreadGuard guard{*this};
+  EraseHandler(typeid(EventHandler<Args...>));
+}
+
+template <typename... Args> void EventDispatcher::Dispatch(Args... args) {
+  EVENT_SYSTEM_TRACE_SPAN(EventTracer::SpanKind::kDispatch,
+                          typeid(EventHandler<Args...>));
+  TimerThreadGuard guard{*this};
+  if (!policies_.empty()) {
+    if (auto policy = FindPolicy(typeid(EventHandler<Args...>))) {
+      // Only set through SetPolicy, which stores an EventPolicyFilter<Args...>
+      static_cast<ITypedEventPolicyFilter<Args...> *>(policy)->Dispatch(
+          *this, args...);
+      return;
+    }
+  }
+  DeliverEvent<Args...>(args...);
+}
+
 } // namespace event_system
+
+/**
+ * @brief Declares that the handler and dispatch functions of an event type are
+ * instantiated in another translation unit.
+ *
+ * Place it in a shared header next to the event type and pair it with
+ * EVENT_SYSTEM_INSTANTIATE_EVENT in exactly one source file.
+ *
+ * @example EVENT_SYSTEM_EXTERN_EVENT(const PriceUpdateEvent &)
+ */
+#define EVENT_SYSTEM_EXTERN_EVENT(...)                                         \
+  extern template class event_system::EventHandler<__VA_ARGS__>;               \
+  extern template void event_system::EventDispatcher::Dispatch<__VA_ARGS__>(   \
+      __VA_ARGS__);                                                            \
+  extern template void                                                         \
+  event_system::EventDispatcher::RemoveCallback<__VA_ARGS__>(size_t)
+
+/**
+ * @brief Instantiates the handler and dispatch functions of an event type.
+ * @see EVENT_SYSTEM_EXTERN_EVENT
+ */
+#define EVENT_SYSTEM_INSTANTIATE_EVENT(...)                                    \
+  template class event_system::EventHandler<__VA_ARGS__>;                      \
+  template void event_system::EventDispatcher::Dispatch<__VA_ARGS__>(          \
+      __VA_ARGS__);                                                            \
+  template void event_system::EventDispatcher::RemoveCallback<__VA_ARGS__>(    \
+      size_t)
+
+#ifdef EVENT_SYSTEM_HEADER_ONLY
+#include "impl/event_dispatcher.ipp"
+#else
+// Commonly used event types, compiled once into the event_system library
+EVENT_SYSTEM_EXTERN_EVENT();
+EVENT_SYSTEM_EXTERN_EVENT(int);
+EVENT_SYSTEM_EXTERN_EVENT(double);
+EVENT_SYSTEM_EXTERN_EVENT(const std::string &);
+#endif
@@ -4,11 +4,31 @@
 
 #pragma once
 
+#include "event_system_fwd.h"
+#include <cstddef>
 #include <functional>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#ifdef EVENT_SYSTEM_ENABLE_TRACING
+#include "event_tracer.h"
+#endif
+
 namespace event_system {
 
+/**
+ * @brief Splits [0, item_count) into ranges of up to items_per_task items and
+ * runs task(begin, end) for each of them on the thread pool, see
+ * ThreadPool::ParallelFor.
+ *
+ * @note Defined with ThreadPool, declared here so handlers don't need to
+ * include thread_pool.h.
+ */
+void ParallelForRanges(ThreadPool &thread_pool, size_t item_count,
+                       size_t items_per_task,
+                       const std::function<void(size_t, size_t)> &task);
+
 /**
  * @class IEventHandler
  * @brief Interface for all event handlers
@@ -41,29 +61,34 @@ public:
    * @brief Adds a callback.
    * @param callback Function to be called when an event is received.
    */
-  size_t AddCallback(const Callback &callback) {
-    static size_t id = 0;
-    callbacks_[id] = callback;
-    return id++;
-  }
+  size_t AddCallback(const Callback &callback);
 
   /**
    * @brief Removes a callback.
    * @param callback_id Index of the callback to remove.
    */
-  void RemoveCallback(size_t callback_id) { callbacks_.erase(callback_id); }
+  void RemoveCallback(size_t callback_id);
 
   /**
    * @brief Iterates through all registered callbacks, calling them with the
    * provided arguments.
    * @param args Arguments to be passed to the callbacks.
    */
-  void OnEvent(Args... args) {
-    // TODO: Map may be modified while iterating, fix this
-    for (auto &[_, callback] : callbacks_) {
-      callback(args...);
-    }
-  }
+  void OnEvent(Args... args);
+
+  /**
+   * @brief Calls all registered callbacks with the provided arguments, split
+   * into tasks that run concurrently on the thread pool. Returns once every
+   * callback has finished.
+   * @param thread_pool Pool the callbacks will be run on.
+   * @param callbacks_per_task Amount of callbacks run serially by each task.
+   * @param args Arguments to be passed to the callbacks.
+   *
+   * @note Callbacks must be independent of each other, arguments are shared
+   * between all of them.
+   */
+  void OnEventParallel(ThreadPool &thread_pool, size_t callbacks_per_task,
+                       Args... args);
 
   [[nodiscard]] size_t GetCallbackCount() const { return callbacks_.size(); }
 
@@ -71,4 +96,54 @@ private:
   std::unordered_map<size_t, Callback> callbacks_;
 };
 
+// Defined out of class so explicit instantiations can be shared between
+// translation units, see EVENT_SYSTEM_EXTERN_EVENT
+
+template <typename... Args>
+size_t EventHandler<Args...>::AddCallback(const Callback &callback) {
+  static size_t id = 0;
+  callbacks_[id] = callback;
+  return id++;
+}
+
+template <typename... Args>
+void EventHandler<Args...>::RemoveCallback(size_t callback_id) {
+  callbacks_.erase(callback_id);
+}
+
+template <typename... Args> void EventHandler<Args...>::OnEvent(Args... args) {
+  // TODO: Map may be modified while iterating, fix this
+  for (auto &[callback_id, callback] : callbacks_) {
+    EVENT_SYSTEM_TRACE_SPAN(EventTracer::SpanKind::kCallback,
+                            typeid(EventHandler<Args...>), callback_id);
+    callback(args...);
+  }
+}
+
+template <typename... Args>
+void EventHandler<Args...>::OnEventParallel(ThreadPool &thread_pool,
+                                            size_t callbacks_per_task,
+                                            Args... args) {
+  // The map can't be split into ranges, so collect the callbacks first
+  std::vector<std::pair<size_t, Callback *>> callbacks;
+  callbacks.reserve(callbacks_.size());
+  for (auto &[callback_id, callback] : callbacks_) {
+    callbacks.emplace_back(callback_id, &callback);
+  }
+
+  ParallelForRanges(thread_pool, callbacks.size(), callbacks_per_task,
+                    [&](size_t begin, size_t end) {
+                      for (size_t i = begin; i < end; ++i) {
+                        EVENT_SYSTEM_TRACE_SPAN(EventTracer::SpanKind::kCallback,
+                                                typeid(EventHandler<Args...>),
+                                                callbacks[i].first);
+                        (*callbacks[i].second)(args...);
+                      }
+                    });
+}
+
 } // namespace event_system
+
+#ifdef EVENT_SYSTEM_HEADER_ONLY
+#include "thread_pool.h"
+#endif
@@ -0,0 +1,273 @@
+//
+// Created by Andres Suazo
+//
+
+#pragma once
+
+#include "event_dispatcher.h"
+#include "event_system_fwd.h"
+#include "timer_wheel.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace event_system {
+
+/**
+ * @struct EventPolicy
+ * @brief Describes how bursts of events of a specific type are reduced before
+ * they reach the registered callbacks.
+ * @tparam Args The event type the policy applies to.
+ *
+ * Policies are applied in the following order:
+ * 1. Coalescing: buffered events with the same key replace each other, only
+ *    the last value is delivered.
+ * 2. Batching: buffered events are delivered together once batch_size events
+ *    are waiting or flush_interval has elapsed.
+ * 3. Rate limiting: events exceeding the token bucket are dropped as they are
+ *    delivered, so the value kept for a key is always the latest one.
+ *
+ * Events are buffered whenever coalesce_key, batch_size or flush_interval are
+ * set, otherwise they are delivered right away. Events still buffered when
+ * the dispatcher is destroyed are dropped, call FlushEvents to deliver them.
+ *
+ * @example EventPolicy<int>{.max_events_per_second = 100, .burst_size = 10}
+ */
+template <typename... Args> struct EventPolicy {
+  using KeyFunction = std::function<size_t(const std::decay_t<Args> &...)>;
+
+  // Returns the key used to coalesce buffered events, requires batch_size or
+  // flush_interval so buffered events are eventually delivered
+  KeyFunction coalesce_key;
+  // Amount of buffered events that triggers a flush, 0 disables batching
+  size_t batch_size = 0;
+  // Maximum time an event stays buffered, requires the dispatcher timers to
+  // be ticked
+  TimerClock::duration flush_interval = TimerClock::duration::zero();
+  // Token refill rate, 0 disables rate limiting
+  double max_events_per_second = 0;
+  // Maximum amount of events accepted at once by the rate limiter
+  size_t burst_size = 1;
+};
+
+/**
+ * @struct EventPolicyStats
+ * @brief Counters kept for every event type with a policy.
+ */
+struct EventPolicyStats {
+  size_t received = 0;
+  size_t delivered = 0;
+  size_t coalesced = 0;
+  size_t rate_limited = 0;
+
+  /**
+   * @brief Returns the amount of events that never reached the callbacks.
+   */
+  [[nodiscard]] size_t GetSuppressedCount() const {
+    return coalesced + rate_limited;
+  }
+};
+
+/**
+ * @class EventPolicyFilter
+ * @brief Holds the runtime state needed to apply an EventPolicy.
+ * @tparam Args The event type the policy applies to.
+ *
+ * Buffered events are stored as copies, so reference event types remain
+ * valid until they are flushed.
+ */
+template <typename... Args>
+class EventPolicyFilter : public ITypedEventPolicyFilter<Args...> {
+public:
+  using Event = std::tuple<std::decay_t<Args>...>;
+
+  /**
+   * @throws std::invalid_argument If coalesce_key is set without batch_size
+   * or flush_interval.
+   */
+  explicit EventPolicyFilter(EventPolicy<Args...> policy)
+      : policy_(std::move(policy)),
+        tokens_(static_cast<double>(policy_.burst_size)),
+        last_refill_(TimerClock::now()) {
+    if (policy_.coalesce_key && policy_.batch_size == 0 &&
+        policy_.flush_interval <= TimerClock::duration::zero()) {
+      throw std::invalid_argument(
+          "coalesce_key requires batch_size or flush_interval");
+    }
+  }
+
+  void Dispatch(EventDispatcher &dispatcher, Args... args) override {
+    dispatcher.DispatchWithPolicy<Args...>(*this, args...);
+  }
+
+  /**
+   * @brief Takes a token from the rate limiter.
+   * @param now Current time.
+   * @returns bool False if the event exceeds the rate limit and must be
+   * dropped.
+   */
+  bool TryAcquire(TimerClock::time_point now) {
+    std::chrono::duration<double> elapsed = now - last_refill_;
+    last_refill_ = now;
+    tokens_ = std::min(static_cast<double>(policy_.burst_size),
+                       tokens_ + elapsed.count() * policy_.max_events_per_second);
+    if (tokens_ < 1.0) {
+      ++stats_.rate_limited;
+      return false;
+    }
+    tokens_ -= 1.0;
+    return true;
+  }
+
+  /**
+   * @brief Stores an event until the next flush, replacing any buffered
+   * event with the same key.
+   * @param args The event to be buffered.
+   */
+  void Buffer(Args... args) {
+    if (policy_.coalesce_key) {
+      auto [it, inserted] =
+          buffered_keys_.try_emplace(policy_.coalesce_key(args...), buffer_.size());
+      if (!inserted) {
+        buffer_[it->second] = Event{args...};
+        ++stats_.coalesced;
+        return;
+      }
+    }
+    buffer_.emplace_back(args...);
+  }
+
+  /**
+   * @brief Removes and returns all buffered events in arrival order.
+   */
+  [[nodiscard]] std::vector<Event> TakeBuffered() {
+    buffered_keys_.clear();
+    return std::exchange(buffer_, {});
+  }
+
+  [[nodiscard]] bool IsRateLimited() const {
+    return policy_.max_events_per_second > 0;
+  }
+
+  [[nodiscard]] bool IsBuffered() const {
+    return policy_.coalesce_key || policy_.batch_size > 0 ||
+           policy_.flush_interval > TimerClock::duration::zero();
+  }
+
+  [[nodiscard]] bool IsBatchFull() const {
+    return policy_.batch_size > 0 && buffer_.size() >= policy_.batch_size;
+  }
+
+  [[nodiscard]] size_t GetBufferedCount() const { return buffer_.size(); }
+
+  [[nodiscard]] const EventPolicy<Args...> &GetPolicy() const { return policy_; }
+
+  [[nodiscard]] EventPolicyStats &GetStats() { return stats_; }
+
+  // Pending flush_interval timer, if any
+  TimerId flush_timer = kInvalidTimerId;
+
+private:
+  EventPolicy<Args...> policy_;
+  EventPolicyStats stats_;
+
+  double tokens_;
+  TimerClock::time_point last_refill_;
+
+  std::vector<Event> buffer_;
+  // Maps a coalescing key to the index of its event in buffer_
+  std::unordered_map<size_t, size_t> buffered_keys_;
+};
+
+// Policy functions of EventDispatcher, declared in event_dispatcher.h
+
+template <typename... Args>
+void EventDispatcher::SetPolicy(EventPolicy<Args...> policy) {
+  TimerThreadGuard guard{*this};
+  auto filter = std::make_unique<EventPolicyFilter<Args...>>(std::move(policy));
+  FlushEvents<Args...>();
+  SetPolicyFilter(typeid(EventHandler<Args...>), std::move(filter));
+}
+
+template <typename... Args> void EventDispatcher::ClearPolicy() {
+  TimerThreadGuard guard{*this};
+  FlushEvents<Args...>();
+  SetPolicyFilter(typeid(EventHandler<Args...>), nullptr);
+}
+
+template <typename... Args> void EventDispatcher::FlushEvents() {
+  TimerThreadGuard guard{*this};
+  auto policy = GetPolicy<Args...>();
+  if (!policy) {
+    return;
+  }
+
+  if (policy->flush_timer != kInvalidTimerId) {
+    CancelTimer(policy->flush_timer);
+    policy->flush_timer = kInvalidTimerId;
+  }
+
+  // Buffer is taken first since callbacks may dispatch more events
+  auto events = policy->TakeBuffered();
+  if (policy->IsRateLimited()) {
+    auto now = TimerClock::now();
+    std::erase_if(events, [policy, now](const auto &) {
+      return !policy->TryAcquire(now);
+    });
+  }
+  policy->GetStats().delivered += events.size();
+  for (auto &event : events) {
+    std::apply([this](auto &...event_args) { DeliverEvent<Args...>(event_args...); },
+               event);
+  }
+}
+
+template <typename... Args>
+EventPolicyStats EventDispatcher::GetPolicyStats() {
+  TimerThreadGuard guard{*this};
+  auto policy = GetPolicy<Args...>();
+  return policy ? policy->GetStats() : EventPolicyStats{};
+}
+
+template <typename... Args>
+EventPolicyFilter<Args...> *EventDispatcher::GetPolicy() {
+  return static_cast<EventPolicyFilter<Args...> *>(
+      FindPolicy(typeid(EventHandler<Args...>)));
+}
+
+template <typename... Args>
+void EventDispatcher::DispatchWithPolicy(EventPolicyFilter<Args...> &policy,
+                                         Args... args) {
+  auto &stats = policy.GetStats();
+  ++stats.received;
+  if (!policy.IsBuffered()) {
+    if (policy.IsRateLimited() && !policy.TryAcquire(TimerClock::now())) {
+      return;
+    }
+    ++stats.delivered;
+    DeliverEvent<Args...>(args...);
+    return;
+  }
+
+  policy.Buffer(args...);
+  if (policy.IsBatchFull()) {
+    FlushEvents<Args...>();
+    return;
+  }
+
+  auto flush_interval = policy.GetPolicy().flush_interval;
+  if (flush_interval > TimerClock::duration::zero() &&
+      policy.flush_timer == kInvalidTimerId) {
+    policy.flush_timer = ScheduleTask(flush_interval.count(), 0,
+                                      [this] { FlushEvents<Args...>(); });
+  }
+}
+
+} // namespace event_system
@@ -0,0 +1,56 @@
+//
+// Created by Andres Suazo
+//
+
+#pragma once
+
+#include <cstdint>
+
+// Non-template definitions are compiled into the event_system library unless
+// EVENT_SYSTEM_HEADER_ONLY is defined, in which case they are inlined into the
+// headers
+#ifdef EVENT_SYSTEM_HEADER_ONLY
+#define EVENT_SYSTEM_INLINE inline
+#else
+#define EVENT_SYSTEM_INLINE
+#endif
+
+namespace event_system {
+
+/**
+ * @brief Identifies a delayed or periodic timer.
+ */
+using TimerId = uint64_t;
+
+/**
+ * @brief Identifier that never refers to a scheduled timer.
+ */
+inline constexpr TimerId kInvalidTimerId = 0;
+
+class IEventHandler;
+template <typename... Args> class EventHandler;
+
+class IEventPolicyFilter;
+template <typename... Args> class EventPolicyFilter;
+template <typename... Args> struct EventPolicy;
+struct EventPolicyStats;
+
+class TimerWheel;
+class ThreadPool;
+class EventDispatcher;
+
+} // namespace event_system
+
+/**
+ * @brief Traces the enclosing scope as a span. Expands to nothing unless
+ * EVENT_SYSTEM_ENABLE_TRACING is defined, in which case event_tracer.h must be
+ * included.
+ *
+ * @example EVENT_SYSTEM_TRACE_SPAN(EventTracer::SpanKind::kDispatch, typeid(int))
+ */
+#ifdef EVENT_SYSTEM_ENABLE_TRACING
+#define EVENT_SYSTEM_TRACE_SPAN(...)                                           \
+  ::event_system::TraceSpan event_system_trace_span { __VA_ARGS__ }
+#else
+#define EVENT_SYSTEM_TRACE_SPAN(...) static_cast<void>(0)
+#endif
@@ -0,0 +1,39 @@
+//
+// Created by Andres Suazo
+//
+
+#pragma once
+
+#include "event_dispatcher.h"
+#include "event_system_fwd.h"
+#include "timer_wheel.h"
+#include <chrono>
+#include <cstdint>
+
+namespace event_system {
+
+// Timer functions of EventDispatcher that take a duration or time point,
+// declared in event_dispatcher.h
+
+static_assert(sizeof(TimerClock::rep) <= sizeof(int64_t),
+              "TimerClock ticks must fit the int64_t passed to the dispatcher");
+
+template <typename... Args, typename Duration>
+TimerId EventDispatcher::DispatchAfter(Duration delay, Args... args) {
+  // Rounded up so events are never dispatched early
+  auto timer_delay = std::chrono::ceil<TimerClock::duration>(delay);
+  return ScheduleDispatch<Args...>(timer_delay.count(), 0, args...);
+}
+
+template <typename... Args, typename Duration>
+TimerId EventDispatcher::DispatchEvery(Duration period, Args... args) {
+  auto timer_period = std::chrono::ceil<TimerClock::duration>(period);
+  return ScheduleDispatch<Args...>(timer_period.count(), timer_period.count(),
+                                   args...);
+}
+
+template <typename TimePoint> size_t EventDispatcher::Tick(TimePoint now) {
+  return TickTimers(TimerClock::time_point{now}.time_since_epoch().count());
+}
+
+} // namespace event_system
@@ -0,0 +1,136 @@
+//
+// Created by Andres Suazo
+//
+
+#pragma once
+
+#include "event_system_fwd.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <typeinfo>
+
+namespace event_system {
+
+/**
+ * @class EventTracer
+ * @brief Records the begin and end of dispatch and callback spans so latency
+ * spikes can be traced back to an event type and callback.
+ *
+ * Every thread writes into its own fixed size ring buffer without locking,
+ * once a buffer is full the oldest records are overwritten. Buffers of threads
+ * that exited are reused by new threads, so their records are kept until
+ * then. Records are exported in the Chrome trace event format, which can be
+ * opened in chrome://tracing or the Perfetto UI.
+ *
+ * Hooks are only compiled in when EVENT_SYSTEM_ENABLE_TRACING is defined, see
+ * EVENT_SYSTEM_TRACE_SPAN. Recording starts disabled.
+ *
+ * @note Export and Clear should be called while no events are being
+ * dispatched, records written during an export may be read partially.
+ */
+class EventTracer {
+public:
+  enum class SpanKind : uint8_t { kDispatch, kCallback };
+
+  /**
+   * @brief Callback id used for spans that are not tied to a callback.
+   */
+  static constexpr size_t kNoCallback = SIZE_MAX;
+
+  /**
+   * @brief Amount of records kept per thread.
+   */
+  static constexpr size_t kBufferCapacity = 1 << 14;
+
+  /**
+   * @brief Enables or disables recording for all threads.
+   */
+  static void SetEnabled(bool enabled) {
+    enabled_.store(enabled, std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] static bool IsEnabled() {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Records the start of a span on the calling thread.
+   * @param kind Whether the span covers a whole dispatch or a single callback.
+   * @param event_type Type of the EventHandler receiving the event.
+   * @param callback_id Identifier of the callback, if any.
+   */
+  static void Begin(SpanKind kind, const std::type_info &event_type,
+                    size_t callback_id = kNoCallback);
+
+  /**
+   * @brief Records the end of the span last started on the calling thread.
+   */
+  static void End(SpanKind kind, const std::type_info &event_type,
+                  size_t callback_id = kNoCallback);
+
+  /**
+   * @brief Writes all recorded spans as Chrome trace event JSON.
+   * @param output Stream the JSON document is written to.
+   */
+  static void WriteChromeTrace(std::ostream &output);
+
+  /**
+   * @brief Discards all recorded spans.
+   */
+  static void Clear();
+
+  /**
+   * @brief Returns the amount of records available for export.
+   * @return size_t The amount of records across all threads
+   */
+  [[nodiscard]] static size_t GetRecordCount();
+
+  /**
+   * @brief Returns the amount of per thread buffers allocated so far.
+   * @return size_t The amount of buffers, in use or waiting to be reused
+   */
+  [[nodiscard]] static size_t GetBufferCount();
+
+private:
+  // Inline so disabled hooks only cost a relaxed load
+  static inline std::atomic<bool> enabled_ = false;
+};
+
+/**
+ * @class TraceSpan
+ * @brief Records a span for the lifetime of the object.
+ */
+class TraceSpan {
+public:
+  TraceSpan(EventTracer::SpanKind kind, const std::type_info &event_type,
+            size_t callback_id = EventTracer::kNoCallback)
+      : kind_(kind), event_type_(event_type), callback_id_(callback_id),
+        recording_(EventTracer::IsEnabled()) {
+    if (recording_) {
+      EventTracer::Begin(kind_, event_type_, callback_id_);
+    }
+  }
+
+  ~TraceSpan() {
+    if (recording_) {
+      EventTracer::End(kind_, event_type_, callback_id_);
+    }
+  }
+
+  TraceSpan(const TraceSpan &) = delete;
+  TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+  EventTracer::SpanKind kind_;
+  const std::type_info &event_type_;
+  size_t callback_id_;
+  bool recording_;
+};
+
+} // namespace event_system
+
+#ifdef EVENT_SYSTEM_HEADER_ONLY
+#include "impl/event_tracer.ipp"
+#endif
@@ -0,0 +1,181 @@
+//
+// Created by Andres Suazo
+//
+
+#pragma once
+
+#include "../event_dispatcher.h"
+#include "../thread_pool.h"
+#include "../timer_wheel.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace event_system {
+
+struct EventDispatcher::TimerState {
+  // Recursive since dispatched events may schedule new timers
+  std::recursive_mutex mutex;
+  TimerWheel timers;
+  std::thread thread;
+  std::atomic<bool> thread_running = false;
+};
+
+EVENT_SYSTEM_INLINE
+EventDispatcher::EventDispatcher()
+    : timer_state_(std::make_unique<TimerState>()) {}
+
+EVENT_SYSTEM_INLINE
+EventDispatcher::~EventDispatcher() { StopTimerThread(); }
+
+EVENT_SYSTEM_INLINE
+bool EventDispatcher::CancelTimer(TimerId timer_id) {
+  TimerThreadGuard guard{*this};
+  return timer_state_->timers.Cancel(timer_id);
+}
+
+EVENT_SYSTEM_INLINE
+bool EventDispatcher::LockTimerState() const {
+  // thread_pool_ is only written by the owning thread, and read here either
+  // by it or by a pool thread running a dispatch it started
+  if (thread_pool_ && thread_pool_->IsInTask()) {
+    throw std::logic_error(
+        "Callbacks dispatched in parallel must not call into the dispatcher");
+  }
+  if (!timer_state_->thread_running.load(std::memory_order_acquire)) {
+    return false;
+  }
+  timer_state_->mutex.lock();
+  return true;
+}
+
+EVENT_SYSTEM_INLINE
+void EventDispatcher::UnlockTimerState() const {
+  timer_state_->mutex.unlock();
+}
+
+EVENT_SYSTEM_INLINE
+size_t EventDispatcher::Tick() {
+  return TickTimers(TimerClock::now().time_since_epoch().count());
+}
+
+EVENT_SYSTEM_INLINE
+size_t EventDispatcher::TickTimers(int64_t now) {
+  TimerThreadGuard guard{*this};
+  return timer_state_->timers.Tick(
+      TimerClock::time_point{TimerClock::duration{now}});
+}
+
+EVENT_SYSTEM_INLINE
+void EventDispatcher::StartTimerThread() {
+  if (timer_state_->thread_running.exchange(true)) {
+    return;
+  }
+  timer_state_->thread = std::thread([this] {
+    while (timer_state_->thread_running) {
+      Tick();
+      std::this_thread::sleep_for(timer_state_->timers.GetResolution());
+    }
+  });
+}
+
+EVENT_SYSTEM_INLINE
+void EventDispatcher::StopTimerThread() {
+  timer_state_->thread_running = false;
+  if (timer_state_->thread.joinable()) {
+    timer_state_->thread.join();
+  }
+}
+
+EVENT_SYSTEM_INLINE
+size_t EventDispatcher::GetPendingTimerCount() const {
+  TimerThreadGuard guard{*this};
+  return timer_state_->timers.GetPendingCount();
+}
+
+EVENT_SYSTEM_INLINE
+std::size_t EventDispatcher::GetHandlerCount() const {
+  TimerThreadGuard guard{*this};
+  return handlers_.size();
+}
+
+EVENT_SYSTEM_INLINE
+TimerId EventDispatcher::ScheduleTask(int64_t delay, int64_t period,
+                                      std::function<void()> task) {
+  TimerThreadGuard guard{*this};
+  auto &timers = timer_state_->timers;
+  TimerClock::duration timer_delay{delay};
+  // The wheel only advances on Tick, add the time elapsed since the last tick
+  // so the delay is measured from now
+  auto lag = TimerClock::now() - timers.GetCurrentTime();
+  if (lag > TimerClock::duration::zero()) {
+    timer_delay += lag;
+  }
+  return timers.Schedule(timer_delay, std::move(task),
+                         TimerClock::duration{period});
+}
+
+EVENT_SYSTEM_INLINE
+ThreadPool &EventDispatcher::GetThreadPool() {
+  if (!thread_pool_) {
+    size_t hardware_threads = std::thread::hardware_concurrency();
+    thread_pool_ = std::make_unique<ThreadPool>(
+        hardware_threads > 1 ? hardware_threads - 1 : 1);
+  }
+  return *thread_pool_;
+}
+
+EVENT_SYSTEM_INLINE
+IEventHandler *EventDispatcher::FindHandler(const std::type_info &handler_type) {
+  auto it = handlers_.find(std::type_index(handler_type));
+  return it != handlers_.end() ? it->second.get() : nullptr;
+}
+
+EVENT_SYSTEM_INLINE
+IEventHandler &
+EventDispatcher::AddHandler(const std::type_info &handler_type,
+                            std::unique_ptr<IEventHandler> handler) {
+  return *handlers_.emplace(std::type_index(handler_type), std::move(handler))
+              .first->second;
+}
+
+EVENT_SYSTEM_INLINE
+void EventDispatcher::EraseHandler(const std::type_info &handler_type) {
+  handlers_.erase(std::type_index(handler_type));
+}
+
+EVENT_SYSTEM_INLINE
+IEventPolicyFilter *
+EventDispatcher::FindPolicy(const std::type_info &handler_type) {
+  auto it = policies_.find(std::type_index(handler_type));
+  return it != policies_.end() ? it->second.get() : nullptr;
+}
+
+EVENT_SYSTEM_INLINE
+void EventDispatcher::SetPolicyFilter(
+    const std::type_info &handler_type,
+    std::unique_ptr<IEventPolicyFilter> policy) {
+  if (policy) {
+    policies_[std::type_index(handler_type)] = std::move(policy);
+  } else {
+    policies_.erase(std::type_index(handler_type));
+  }
+}
+
+EVENT_SYSTEM_INLINE
+const ParallelDispatchOptions *
+EventDispatcher::FindParallelOptions(const std::type_info &handler_type) const {
+  auto it = parallel_options_.find(std::type_index(handler_type));
+  return it != parallel_options_.end() ? &it->second : nullptr;
+}
+
+EVENT_SYSTEM_INLINE
+void EventDispatcher::LogMissingHandler(const std::type_info &handler_type) {
+  std::clog << "No handler for event type: " << handler_type.name()
+            << std::endl;
+}
+
+} // namespace event_system
@@ -0,0 +1,248 @@
+//
+// Created by Andres Suazo
+//
+
+#pragma once
+
+#include "../event_tracer.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+namespace event_system {
+
+namespace detail {
+
+struct TraceRecord {
+  uint64_t timestamp_ns;
+  const std::type_info *event_type;
+  size_t callback_id;
+  EventTracer::SpanKind kind;
+  bool begin;
+};
+
+/**
+ * @brief Single producer ring buffer, only written by its owning thread.
+ */
+struct TraceBuffer {
+  explicit TraceBuffer(uint32_t thread_id) : thread_id(thread_id) {}
+
+  std::array<TraceRecord, EventTracer::kBufferCapacity> records{};
+  // Total amount of records ever written
+  std::atomic<uint64_t> head = 0;
+  // Records before this position have been cleared
+  std::atomic<uint64_t> tail = 0;
+  uint32_t thread_id;
+
+  [[nodiscard]] uint64_t GetFirstAvailable(uint64_t current_head) const {
+    uint64_t oldest = current_head > EventTracer::kBufferCapacity
+                          ? current_head - EventTracer::kBufferCapacity
+                          : 0;
+    return std::max(oldest, tail.load(std::memory_order_relaxed));
+  }
+};
+
+struct TraceRegistry {
+  // Only locked when a thread records for the first time or exits, and on
+  // export
+  std::mutex mutex;
+  std::vector<std::unique_ptr<TraceBuffer>> buffers;
+  // Buffers of threads that exited, waiting to be reused
+  std::vector<TraceBuffer *> free_buffers;
+  uint32_t next_thread_id = 1;
+};
+
+EVENT_SYSTEM_INLINE
+TraceRegistry &GetTraceRegistry() {
+  // Never destroyed so threads still running at exit can keep recording
+  static auto *registry = new TraceRegistry();
+  return *registry;
+}
+
+/**
+ * @brief Owns the buffer of a thread, handing it back to the registry once
+ * the thread exits.
+ */
+struct ThreadTraceBuffer {
+  TraceBuffer *buffer = nullptr;
+
+  ~ThreadTraceBuffer() {
+    if (buffer) {
+      auto &registry = GetTraceRegistry();
+      std::lock_guard lock{registry.mutex};
+      registry.free_buffers.push_back(buffer);
+    }
+  }
+};
+
+EVENT_SYSTEM_INLINE
+TraceBuffer &GetThreadTraceBuffer() {
+  thread_local ThreadTraceBuffer thread_buffer;
+  if (!thread_buffer.buffer) {
+    auto &registry = GetTraceRegistry();
+    std::lock_guard lock{registry.mutex};
+    uint32_t thread_id = registry.next_thread_id++;
+    if (registry.free_buffers.empty()) {
+      thread_buffer.buffer =
+          registry.buffers
+              .emplace_back(std::make_unique<TraceBuffer>(thread_id))
+              .get();
+    } else {
+      // Records of the previous thread are dropped so they are not exported
+      // under the new thread id
+      thread_buffer.buffer = registry.free_buffers.back();
+      registry.free_buffers.pop_back();
+      thread_buffer.buffer->thread_id = thread_id;
+      thread_buffer.buffer->tail.store(
+          thread_buffer.buffer->head.load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+    }
+  }
+  return *thread_buffer.buffer;
+}
+
+EVENT_SYSTEM_INLINE
+void Record(EventTracer::SpanKind kind, const std::type_info &event_type,
+            size_t callback_id, bool begin) {
+  auto &buffer = GetThreadTraceBuffer();
+  auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch());
+  uint64_t head = buffer.head.load(std::memory_order_relaxed);
+  buffer.records[head % EventTracer::kBufferCapacity] = {
+      static_cast<uint64_t>(timestamp.count()), &event_type, callback_id, kind,
+      begin};
+  buffer.head.store(head + 1, std::memory_order_release);
+}
+
+EVENT_SYSTEM_INLINE
+std::string GetReadableTypeName(const std::type_info &type) {
+#if defined(__GNUG__)
+  int status = 0;
+  char *demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+  if (status == 0 && demangled) {
+    std::string name{demangled};
+    std::free(demangled);
+    return name;
+  }
+#endif
+  return type.name();
+}
+
+EVENT_SYSTEM_INLINE
+void WriteJsonString(std::ostream &output, const std::string &value) {
+  output << '"';
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      output << '\\';
+    }
+    output << c;
+  }
+  output << '"';
+}
+
+} // namespace detail
+
+EVENT_SYSTEM_INLINE
+void EventTracer::Begin(SpanKind kind, const std::type_info &event_type,
+                        size_t callback_id) {
+  detail::Record(kind, event_type, callback_id, true);
+}
+
+EVENT_SYSTEM_INLINE
+void EventTracer::End(SpanKind kind, const std::type_info &event_type,
+                      size_t callback_id) {
+  detail::Record(kind, event_type, callback_id, false);
+}
+
+EVENT_SYSTEM_INLINE
+void EventTracer::WriteChromeTrace(std::ostream &output) {
+  auto &registry = detail::GetTraceRegistry();
+  std::lock_guard lock{registry.mutex};
+
+  std::unordered_map<const std::type_info *, std::string> type_names;
+  bool first_event = true;
+  output << "{\"traceEvents\":[";
+  for (const auto &buffer : registry.buffers) {
+    uint64_t head = buffer->head.load(std::memory_order_acquire);
+    // Ends whose begin was overwritten are skipped to keep spans balanced
+    size_t depth = 0;
+    for (uint64_t i = buffer->GetFirstAvailable(head); i < head; ++i) {
+      const auto &record = buffer->records[i % kBufferCapacity];
+      if (record.begin) {
+        ++depth;
+      } else if (depth == 0) {
+        continue;
+      } else {
+        --depth;
+      }
+
+      auto name_it = type_names.find(record.event_type);
+      if (name_it == type_names.end()) {
+        name_it = type_names
+                      .emplace(record.event_type,
+                               detail::GetReadableTypeName(*record.event_type))
+                      .first;
+      }
+
+      output << (first_event ? "" : ",") << "\n{\"name\":";
+      detail::WriteJsonString(output, name_it->second);
+      output << ",\"cat\":\""
+             << (record.kind == SpanKind::kDispatch ? "dispatch" : "callback")
+             << "\",\"ph\":\"" << (record.begin ? 'B' : 'E')
+             << "\",\"ts\":" << record.timestamp_ns / 1000 << '.';
+      // Timestamps are in microseconds, keep nanosecond precision
+      auto nanoseconds = std::to_string(record.timestamp_ns % 1000);
+      output << std::string(3 - nanoseconds.size(), '0') << nanoseconds
+             << ",\"pid\":1,\"tid\":" << buffer->thread_id;
+      if (record.callback_id != kNoCallback) {
+        output << ",\"args\":{\"callback_id\":" << record.callback_id << '}';
+      }
+      output << '}';
+      first_event = false;
+    }
+  }
+  output << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+EVENT_SYSTEM_INLINE
+void EventTracer::Clear() {
+  auto &registry = detail::GetTraceRegistry();
+  std::lock_guard lock{registry.mutex};
+  for (const auto &buffer : registry.buffers) {
+    buffer->tail.store(buffer->head.load(std::memory_order_acquire),
+                       std::memory_order_relaxed);
+  }
+}
+
+EVENT_SYSTEM_INLINE
+size_t EventTracer::GetRecordCount() {
+  auto &registry = detail::GetTraceRegistry();
+  std::lock_guard lock{registry.mutex};
+  size_t record_count = 0;
+  for (const auto &buffer : registry.buffers) {
+    uint64_t head = buffer->head.load(std::memory_order_acquire);
+    record_count += head - buffer->GetFirstAvailable(head);
+  }
+  return record_count;
+}
+
+EVENT_SYSTEM_INLINE
+size_t EventTracer::GetBufferCount() {
+  auto &registry = detail::GetTraceRegistry();
+  std::lock_guard lock{registry.mutex};
+  return registry.buffers.size();
+}
+
+} // namespace event_system
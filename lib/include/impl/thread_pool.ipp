@@ -0,0 +1,180 @@
+//
+// Created by Andres Suazo
+//
+
+#pragma once
+
+#include "../thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace event_system {
+
+struct ThreadPool::State {
+  // Pool whose tasks the calling thread is running, if any
+  static const ThreadPool *&CurrentPool() {
+    thread_local const ThreadPool *current_pool = nullptr;
+    return current_pool;
+  }
+
+  /**
+   * @brief Marks the calling thread as running a task of the pool for its
+   * lifetime. Restores the previous pool so nested pools are tracked.
+   */
+  class TaskScope {
+  public:
+    explicit TaskScope(const ThreadPool *pool)
+        : previous_(std::exchange(CurrentPool(), pool)) {}
+    ~TaskScope() { CurrentPool() = previous_; }
+
+    TaskScope(const TaskScope &) = delete;
+    TaskScope &operator=(const TaskScope &) = delete;
+
+  private:
+    const ThreadPool *previous_;
+  };
+
+  /**
+   * @brief Shared progress of a single ParallelFor call.
+   */
+  struct Job {
+    const ThreadPool *pool;
+    const std::function<void(size_t)> *task;
+    size_t task_count;
+    std::atomic<size_t> next_index = 0;
+    std::atomic<size_t> finished_count = 0;
+    std::exception_ptr exception;
+    std::mutex mutex;
+    std::condition_variable finished;
+
+    // Claims and runs tasks until none are left
+    void Work() {
+      TaskScope scope{pool};
+      for (size_t index = next_index.fetch_add(1); index < task_count;
+           index = next_index.fetch_add(1)) {
+        try {
+          (*task)(index);
+        } catch (...) {
+          std::lock_guard lock{mutex};
+          if (!exception) {
+            exception = std::current_exception();
+          }
+        }
+        if (finished_count.fetch_add(1) + 1 == task_count) {
+          std::lock_guard lock{mutex};
+          finished.notify_all();
+        }
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+
+  std::mutex mutex;
+  std::condition_variable wake;
+  // One entry for every worker asked to help with a job. Tasks are claimed
+  // from the job itself, so a worker picking up a finished job returns right
+  // away
+  std::deque<std::shared_ptr<Job>> jobs;
+  bool stopping = false;
+
+  void RunWorker() {
+    while (true) {
+      std::shared_ptr<Job> job;
+      {
+        std::unique_lock lock{mutex};
+        wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+        if (jobs.empty()) {
+          return;
+        }
+        job = std::move(jobs.front());
+        jobs.pop_front();
+      }
+      job->Work();
+    }
+  }
+};
+
+EVENT_SYSTEM_INLINE
+ThreadPool::ThreadPool(size_t worker_count)
+    : state_(std::make_unique<State>()) {
+  for (size_t i = 0; i < worker_count; ++i) {
+    state_->workers.emplace_back([this] { state_->RunWorker(); });
+  }
+}
+
+EVENT_SYSTEM_INLINE
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard lock{state_->mutex};
+    state_->stopping = true;
+  }
+  state_->wake.notify_all();
+  for (auto &worker : state_->workers) {
+    worker.join();
+  }
+}
+
+EVENT_SYSTEM_INLINE
+void ThreadPool::ParallelFor(size_t task_count,
+                             const std::function<void(size_t)> &task) {
+  if (state_->workers.empty() || task_count <= 1) {
+    State::TaskScope scope{this};
+    for (size_t i = 0; i < task_count; ++i) {
+      task(i);
+    }
+    return;
+  }
+
+  // Shared so helpers that start after the job finished can still check it
+  auto job = std::make_shared<State::Job>();
+  job->pool = this;
+  job->task = &task;
+  job->task_count = task_count;
+
+  size_t helper_count = std::min(task_count - 1, state_->workers.size());
+  {
+    std::lock_guard lock{state_->mutex};
+    state_->jobs.insert(state_->jobs.end(), helper_count, job);
+  }
+  for (size_t i = 0; i < helper_count; ++i) {
+    state_->wake.notify_one();
+  }
+
+  job->Work();
+
+  std::unique_lock lock{job->mutex};
+  job->finished.wait(lock,
+                     [&job] { return job->finished_count == job->task_count; });
+  if (job->exception) {
+    std::rethrow_exception(job->exception);
+  }
+}
+
+EVENT_SYSTEM_INLINE
+bool ThreadPool::IsInTask() const { return State::CurrentPool() == this; }
+
+EVENT_SYSTEM_INLINE
+size_t ThreadPool::GetWorkerCount() const { return state_->workers.size(); }
+
+// Declared in event_handler.h
+EVENT_SYSTEM_INLINE
+void ParallelForRanges(ThreadPool &thread_pool, size_t item_count,
+                       size_t items_per_task,
+                       const std::function<void(size_t, size_t)> &task) {
+  items_per_task = std::max<size_t>(items_per_task, 1);
+  size_t task_count = (item_count + items_per_task - 1) / items_per_task;
+  thread_pool.ParallelFor(task_count, [&](size_t task_index) {
+    size_t begin = task_index * items_per_task;
+    task(begin, std::min(begin + items_per_task, item_count));
+  });
+}
+
+} // namespace event_system
@@ -0,0 +1,226 @@
+//
+// Created by Andres Suazo
+//
+
+#pragma once
+
+#include "../timer_wheel.h"
+#include <algorithm>
+
+namespace event_system {
+
+EVENT_SYSTEM_INLINE
+TimerWheel::TimerWheel(Clock::duration resolution, Clock::time_point start)
+    : resolution_(resolution), start_(start) {
+  slots_.fill(kNoNode);
+}
+
+EVENT_SYSTEM_INLINE
+TimerWheel::TimerId TimerWheel::Schedule(Clock::duration delay, Task task,
+                                         Clock::duration period) {
+  uint32_t index = AllocateNode();
+  Node &node = nodes_[index];
+  node.task = std::move(task);
+  node.expiry = current_tick_ + ToTicks(delay);
+  node.period = period > Clock::duration::zero() ? ToTicks(period) : 0;
+  node.active = true;
+  Insert(index);
+  ++pending_count_;
+  return (static_cast<uint64_t>(node.generation) << 32) | (index + 1);
+}
+
+EVENT_SYSTEM_INLINE
+bool TimerWheel::Cancel(TimerId timer_id) {
+  if (timer_id == kInvalidTimerId) {
+    return false;
+  }
+  uint64_t index = (timer_id & UINT32_MAX) - 1;
+  auto generation = static_cast<uint32_t>(timer_id >> 32);
+  if (index >= nodes_.size()) {
+    return false;
+  }
+
+  Node &node = nodes_[index];
+  if (!node.active || node.generation != generation) {
+    return false;
+  }
+
+  node.active = false;
+  --pending_count_;
+  // A running periodic timer is released once its task returns
+  if (!node.running) {
+    Unlink(index);
+    ReleaseNode(index);
+  }
+  return true;
+}
+
+EVENT_SYSTEM_INLINE
+size_t TimerWheel::Tick(Clock::time_point now) {
+  if (now < start_) {
+    return 0;
+  }
+
+  auto target = static_cast<uint64_t>((now - start_) / resolution_);
+  size_t run_count = 0;
+  while (current_tick_ < target) {
+    if (pending_count_ == 0) {
+      // Nothing to cascade or run, skip straight to the target tick
+      current_tick_ = target;
+      break;
+    }
+
+    // Nothing runs or cascades before the next tick that cascades the lowest
+    // level holding timers, skip straight to it
+    size_t empty_levels = 0;
+    while (empty_levels + 1 < kLevelCount && level_counts_[empty_levels] == 0) {
+      ++empty_levels;
+    }
+    if (empty_levels > 0) {
+      uint64_t skipped_ticks = (uint64_t{1} << (empty_levels * kSlotBits)) - 1;
+      current_tick_ = std::min(current_tick_ | skipped_ticks, target);
+      if (current_tick_ == target) {
+        break;
+      }
+    }
+
+    ++current_tick_;
+    for (size_t level = 1; level < kLevelCount; ++level) {
+      if (((current_tick_ >> ((level - 1) * kSlotBits)) & kSlotMask) != 0) {
+        break;
+      }
+      Cascade(level);
+    }
+    run_count += RunSlot(current_tick_ & kSlotMask);
+  }
+  return run_count;
+}
+
+EVENT_SYSTEM_INLINE
+uint64_t TimerWheel::ToTicks(Clock::duration duration) const {
+  if (duration <= Clock::duration::zero()) {
+    return 1;
+  }
+  // Round up so timers never fire early
+  auto ticks = static_cast<uint64_t>((duration + resolution_ -
+                                      Clock::duration{1}) / resolution_);
+  return ticks == 0 ? 1 : ticks;
+}
+
+EVENT_SYSTEM_INLINE
+uint32_t TimerWheel::AllocateNode() {
+  if (!free_nodes_.empty()) {
+    uint32_t index = free_nodes_.back();
+    free_nodes_.pop_back();
+    return index;
+  }
+  nodes_.emplace_back();
+  return static_cast<uint32_t>(nodes_.size() - 1);
+}
+
+EVENT_SYSTEM_INLINE
+void TimerWheel::ReleaseNode(uint32_t index) {
+  Node &node = nodes_[index];
+  node.task = nullptr;
+  node.active = false;
+  // Invalidates any identifier still referring to this node
+  ++node.generation;
+  free_nodes_.push_back(index);
+}
+
+EVENT_SYSTEM_INLINE
+void TimerWheel::Insert(uint32_t index) {
+  Node &node = nodes_[index];
+  uint64_t expiry = node.expiry;
+  if (expiry - current_tick_ > kMaxDelta) {
+    // Timers beyond the range of the wheel wait in the furthest slot and are
+    // inserted again once it is cascaded, node.expiry keeps the real expiry
+    expiry = current_tick_ + kMaxDelta;
+  }
+  uint64_t delta = expiry - current_tick_;
+
+  size_t level = 0;
+  while (level + 1 < kLevelCount &&
+         delta >= (uint64_t{1} << ((level + 1) * kSlotBits))) {
+    ++level;
+  }
+
+  auto slot = static_cast<uint32_t>(
+      level * kSlotCount + ((expiry >> (level * kSlotBits)) & kSlotMask));
+  ++level_counts_[level];
+  node.slot = slot;
+  node.prev = kNoNode;
+  node.next = slots_[slot];
+  if (node.next != kNoNode) {
+    nodes_[node.next].prev = index;
+  }
+  slots_[slot] = index;
+}
+
+EVENT_SYSTEM_INLINE
+void TimerWheel::Unlink(uint32_t index) {
+  Node &node = nodes_[index];
+  if (node.slot == kNoNode) {
+    return;
+  }
+  if (node.prev != kNoNode) {
+    nodes_[node.prev].next = node.next;
+  } else {
+    slots_[node.slot] = node.next;
+  }
+  if (node.next != kNoNode) {
+    nodes_[node.next].prev = node.prev;
+  }
+  --level_counts_[node.slot / kSlotCount];
+  node.prev = kNoNode;
+  node.next = kNoNode;
+  node.slot = kNoNode;
+}
+
+EVENT_SYSTEM_INLINE
+void TimerWheel::Cascade(size_t level) {
+  auto slot = static_cast<uint32_t>(
+      level * kSlotCount +
+      ((current_tick_ >> (level * kSlotBits)) & kSlotMask));
+  uint32_t index = slots_[slot];
+  slots_[slot] = kNoNode;
+  while (index != kNoNode) {
+    uint32_t next = nodes_[index].next;
+    nodes_[index].slot = kNoNode;
+    --level_counts_[level];
+    Insert(index);
+    index = next;
+  }
+}
+
+EVENT_SYSTEM_INLINE
+size_t TimerWheel::RunSlot(uint32_t slot) {
+  size_t run_count = 0;
+  // Always take the head since tasks may cancel other timers in this slot
+  while (slots_[slot] != kNoNode) {
+    uint32_t index = slots_[slot];
+    Unlink(index);
+
+    Node &node = nodes_[index];
+    bool periodic = node.period != 0;
+    if (!periodic) {
+      node.active = false;
+      --pending_count_;
+    }
+
+    node.running = true;
+    node.task();
+    node.running = false;
+    ++run_count;
+
+    if (periodic && node.active) {
+      node.expiry = current_tick_ + node.period;
+      Insert(index);
+    } else {
+      ReleaseNode(index);
+    }
+  }
+  return run_count;
+}
+
+} // namespace event_system
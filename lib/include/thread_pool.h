@@ -0,0 +1,69 @@
+//
+// Created by Andres Suazo
+//
+
+#pragma once
+
+#include "event_system_fwd.h"
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+namespace event_system {
+
+/**
+ * @class ThreadPool
+ * @brief Fixed set of worker threads used to run independent callbacks in
+ * parallel.
+ *
+ * Idle workers wait on a shared queue of jobs. The tasks of a job are claimed
+ * one at a time from a shared counter, so threads that finish early keep
+ * taking the remaining tasks. Threads calling ParallelFor take part in the
+ * work, so nested calls from inside a task cannot deadlock.
+ */
+class ThreadPool {
+public:
+  /**
+   * @param worker_count Amount of threads to start. With no workers every
+   * task runs on the calling thread.
+   */
+  explicit ThreadPool(size_t worker_count);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /**
+   * @brief Runs task(i) for every i in [0, task_count) and waits for all of
+   * them to finish.
+   * @param task_count Amount of tasks to run.
+   * @param task Function called with the index of each task. May be called
+   * concurrently from several threads.
+   *
+   * @note If a task throws, the first exception is rethrown once every task
+   * has finished.
+   */
+  void ParallelFor(size_t task_count, const std::function<void(size_t)> &task);
+
+  /**
+   * @brief Returns whether the calling thread is running a task of this pool,
+   * including threads taking part in ParallelFor.
+   */
+  [[nodiscard]] bool IsInTask() const;
+
+  /**
+   * @brief Returns the amount of worker threads.
+   * @return size_t The amount of workers, not counting calling threads
+   */
+  [[nodiscard]] size_t GetWorkerCount() const;
+
+private:
+  struct State;
+  std::unique_ptr<State> state_;
+};
+
+} // namespace event_system
+
+#ifdef EVENT_SYSTEM_HEADER_ONLY
+#include "impl/thread_pool.ipp"
+#endif
@@ -0,0 +1,153 @@
+//
+// Created by Andres Suazo
+//
+
+#pragma once
+
+#include "event_system_fwd.h"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+namespace event_system {
+
+/**
+ * @brief Clock used by every timer in the event system.
+ */
+using TimerClock = std::chrono::steady_clock;
+
+/**
+ * @class TimerWheel
+ * @brief Hierarchical timing wheel used to schedule delayed and periodic
+ * tasks.
+ *
+ * Time is divided into ticks of a fixed resolution. Timers are stored in
+ * intrusive lists inside one of four wheels of 256 slots each, where every
+ * level covers 256 times the range of the previous one. Scheduling and
+ * cancelling a timer are O(1), and timers are cascaded down to the lower
+ * levels as time advances.
+ *
+ * The wheel does not keep track of time on its own, it must be driven by
+ * calling Tick with the current time.
+ *
+ * @note Not thread-safe, callers must synchronize access.
+ */
+class TimerWheel {
+public:
+  using Clock = TimerClock;
+  using Task = std::function<void()>;
+  using TimerId = event_system::TimerId;
+
+  /**
+   * @brief Identifier that never refers to a scheduled timer.
+   */
+  static constexpr TimerId kInvalidTimerId = event_system::kInvalidTimerId;
+
+  /**
+   * @param resolution Duration of a single tick.
+   * @param start Point in time that corresponds to tick 0.
+   */
+  explicit TimerWheel(Clock::duration resolution = std::chrono::milliseconds(1),
+                      Clock::time_point start = Clock::now());
+
+  /**
+   * @brief Schedules a task to run after the given delay.
+   * @param delay Time to wait, measured from the last processed tick.
+   * @param task Function to be called once the timer expires.
+   * @param period If non-zero the task is rescheduled with this period after
+   * every run until cancelled.
+   * @returns TimerId Identifier that can be used to cancel the timer.
+   *
+   * @note Delays are rounded up to whole ticks, with a minimum of one tick.
+   * Delays beyond the range of the wheel, 2^32 ticks, are kept in its last
+   * slot until they are within range.
+   */
+  TimerId Schedule(Clock::duration delay, Task task,
+                   Clock::duration period = Clock::duration::zero());
+
+  /**
+   * @brief Cancels a pending timer.
+   * @param timer_id Identifier returned by Schedule.
+   * @returns bool True if the timer was pending and has been cancelled.
+   */
+  bool Cancel(TimerId timer_id);
+
+  /**
+   * @brief Advances the wheel up to the given point in time, running every
+   * timer that expires on the way.
+   * @param now Current time.
+   * @returns size_t The amount of tasks that were run.
+   */
+  size_t Tick(Clock::time_point now);
+
+  /**
+   * @brief Returns the amount of timers waiting to expire.
+   * @return size_t The amount of pending timers
+   */
+  [[nodiscard]] size_t GetPendingCount() const { return pending_count_; }
+
+  /**
+   * @brief Returns the duration of a single tick.
+   */
+  [[nodiscard]] Clock::duration GetResolution() const { return resolution_; }
+
+  /**
+   * @brief Returns the point in time of the last processed tick, which
+   * Schedule measures delays from.
+   */
+  [[nodiscard]] Clock::time_point GetCurrentTime() const {
+    return start_ + static_cast<Clock::rep>(current_tick_) * resolution_;
+  }
+
+private:
+  static constexpr size_t kLevelCount = 4;
+  static constexpr size_t kSlotBits = 8;
+  static constexpr size_t kSlotCount = 1 << kSlotBits;
+  static constexpr uint64_t kSlotMask = kSlotCount - 1;
+  static constexpr uint32_t kNoNode = UINT32_MAX;
+  static constexpr uint64_t kMaxDelta = (uint64_t{1} << 32) - 1;
+
+  struct Node {
+    Task task;
+    uint64_t expiry = 0;
+    uint64_t period = 0;
+    uint32_t generation = 0;
+    uint32_t prev = kNoNode;
+    uint32_t next = kNoNode;
+    // Slot the node is linked into, or kNoNode when it is not in the wheel
+    uint32_t slot = kNoNode;
+    bool active = false;
+    bool running = false;
+  };
+
+  [[nodiscard]] uint64_t ToTicks(Clock::duration duration) const;
+  uint32_t AllocateNode();
+  void ReleaseNode(uint32_t index);
+  void Insert(uint32_t index);
+  void Unlink(uint32_t index);
+  void Cascade(size_t level);
+  size_t RunSlot(uint32_t slot);
+
+  Clock::duration resolution_;
+  Clock::time_point start_;
+  uint64_t current_tick_ = 0;
+  size_t pending_count_ = 0;
+
+  // Slot heads for every level, indexed as level * kSlotCount + slot
+  std::array<uint32_t, kLevelCount * kSlotCount> slots_;
+  // Amount of timers linked into each level, used to skip idle ticks
+  std::array<size_t, kLevelCount> level_counts_{};
+  // Deque keeps node references valid while tasks schedule new timers
+  std::deque<Node> nodes_;
+  std::vector<uint32_t> free_nodes_;
+};
+
+} // namespace event_system
+
+#ifdef EVENT_SYSTEM_HEADER_ONLY
+#include "impl/timer_wheel.ipp"
+#endif
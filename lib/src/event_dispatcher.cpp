@@ -1,10 +1,7 @@
-
 #include "event_dispatcher.h"
+#include "impl/event_dispatcher.ipp"
 
-namespace event_system {
-
-[[nodiscard]] std::size_t EventDispatcher::GetHandlerCount() const {
-  return handlers_.size();
-}
-
-} // namespace event_system
+EVENT_SYSTEM_INSTANTIATE_EVENT();
+EVENT_SYSTEM_INSTANTIATE_EVENT(int);
+EVENT_SYSTEM_INSTANTIATE_EVENT(double);
+EVENT_SYSTEM_INSTANTIATE_EVENT(const std::string &);
@@ -0,0 +1,2 @@
+#include "event_tracer.h"
+#include "impl/event_tracer.ipp"
@@ -0,0 +1,2 @@
+#include "thread_pool.h"
+#include "impl/thread_pool.ipp"
@@ -0,0 +1,2 @@
+#include "timer_wheel.h"
+#include "impl/timer_wheel.ipp"
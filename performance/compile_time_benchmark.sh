@@ -0,0 +1,64 @@
+#!/usr/bin/env bash
+#
+# Created by Andres Suazo
+#
+# Measures the time needed to compile translation units that use the event
+# system, comparing the event_system library (extern templates and out of
+# class definitions) against the header-only build. When BASELINE_REF is set
+# the same units are also compiled against the headers of that git revision.
+#
+# Usage: [BASELINE_REF=<revision>] ./compile_time_benchmark.sh \
+#          [translation units] [compiler flags...]
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+REPO_DIR="${SCRIPT_DIR}/.."
+CXX="${CXX:-c++}"
+UNIT_COUNT="${1:-20}"
+shift || true
+CXX_FLAGS=("-std=c++20" "-O2" "$@")
+
+WORK_DIR="$(mktemp -d)"
+trap 'rm -rf "${WORK_DIR}"' EXIT
+
+# Every translation unit uses the event types instantiated by the library
+for ((i = 0; i < UNIT_COUNT; ++i)); do
+  cat > "${WORK_DIR}/unit_${i}.cpp" <<SOURCE
+#include "event_dispatcher.h"
+
+void Unit${i}(event_system::EventDispatcher &dispatcher) {
+  dispatcher.AddCallback<int>([](int) {});
+  dispatcher.AddCallback<const std::string &>([](const std::string &) {});
+  dispatcher.Dispatch<int>(${i});
+  dispatcher.Dispatch<const std::string &>("unit_${i}");
+  dispatcher.RemoveCallback<int>(0);
+}
+SOURCE
+done
+
+# Compiles every unit against the given include directory and prints the
+# total and per unit time
+CompileUnits() {
+  local include_dir="$1"
+  shift
+  local start end
+  start=$(date +%s%N)
+  for ((i = 0; i < UNIT_COUNT; ++i)); do
+    "${CXX}" "${CXX_FLAGS[@]}" "$@" -I"${include_dir}" \
+      -c "${WORK_DIR}/unit_${i}.cpp" -o "${WORK_DIR}/unit_${i}.o"
+  done
+  end=$(date +%s%N)
+  local total_ms=$(((end - start) / 1000000))
+  echo "${total_ms} ms ($((total_ms / UNIT_COUNT)) ms per unit)"
+}
+
+echo "Translation units : ${UNIT_COUNT}"
+if [[ -n "${BASELINE_REF:-}" ]]; then
+  mkdir -p "${WORK_DIR}/baseline"
+  git -C "${REPO_DIR}" archive "${BASELINE_REF}" lib/include |
+    tar -x -C "${WORK_DIR}/baseline"
+  echo "Baseline          : $(CompileUnits "${WORK_DIR}/baseline/lib/include")"
+fi
+echo "Library           : $(CompileUnits "${REPO_DIR}/lib/include")"
+echo "Header-only       : $(CompileUnits "${REPO_DIR}/lib/include" -DEVENT_SYSTEM_HEADER_ONLY)"
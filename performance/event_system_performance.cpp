@@ -4,7 +4,11 @@
 
 #include <benchmark/benchmark.h>
 
+#include "event_dispatcher.h"
 #include "event_handler.h"
+#include "event_policy.h"
+#include "event_tracer.h"
+#include "timer_wheel.h"
 
 using namespace event_system;
 
@@ -34,4 +38,169 @@ BENCHMARK(EventHandler_DispatchEventsToCallbacks)
     ->Args({1, 100})
     ->Args({1, 1000});
 
+static void TimerWheel_ScheduleAndCancel(benchmark::State &state) {
+  using namespace std::chrono_literals;
+  auto start = TimerWheel::Clock::now();
+  TimerWheel wheel{1ms, start};
+
+  // Fill the wheel with pending timers spread across every level
+  const size_t pending_amount = state.range(0);
+  for (size_t i = 0; i < pending_amount; ++i) {
+    wheel.Schedule(std::chrono::milliseconds(1 + i % 10000000), [] {});
+  }
+
+  for (auto _ : state) {
+    auto timer_id = wheel.Schedule(5s, [] {});
+    benchmark::DoNotOptimize(wheel.Cancel(timer_id));
+  }
+}
+
+// Cost of inserting and cancelling a timer with up to a million pending
+BENCHMARK(TimerWheel_ScheduleAndCancel)
+    ->Arg(1000)
+    ->Arg(1000000);
+
+static void TimerWheel_TickExpiringTimers(benchmark::State &state) {
+  using namespace std::chrono_literals;
+  const size_t pending_amount = state.range(0);
+  // Every tick of the measured window expires the same amount of timers
+  const size_t window_ticks = 1000;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto start = TimerWheel::Clock::now();
+    TimerWheel wheel{1ms, start};
+    for (size_t i = 0; i < pending_amount; ++i) {
+      wheel.Schedule(std::chrono::milliseconds(1 + i % window_ticks), [] {});
+    }
+    state.ResumeTiming();
+
+    benchmark::DoNotOptimize(wheel.Tick(start + std::chrono::milliseconds(window_ticks)));
+  }
+  state.SetItemsProcessed(state.iterations() * pending_amount);
+}
+
+BENCHMARK(TimerWheel_TickExpiringTimers)
+    ->Arg(1000)
+    ->Arg(1000000)
+    ->Unit(benchmark::kMillisecond);
+
+static void EventDispatcher_DispatchToCallbacks(benchmark::State &state) {
+  EventDispatcher dispatcher;
+
+  const size_t callback_amount = state.range(0);
+  for (size_t i = 0; i < callback_amount; ++i) {
+    dispatcher.AddCallback<int>([](int value) {});
+  }
+
+  for (auto _ : state) {
+    dispatcher.Dispatch<int>(1);
+  }
+}
+
+// Compare against a build without ENABLE_TRACING to measure the cost of the
+// disabled hooks
+BENCHMARK(EventDispatcher_DispatchToCallbacks)->Arg(1)->Arg(10);
+
+#ifdef EVENT_SYSTEM_ENABLE_TRACING
+static void EventDispatcher_DispatchToCallbacksTraced(benchmark::State &state) {
+  EventTracer::SetEnabled(true);
+  EventDispatcher_DispatchToCallbacks(state);
+  EventTracer::SetEnabled(false);
+  EventTracer::Clear();
+}
+
+BENCHMARK(EventDispatcher_DispatchToCallbacksTraced)->Arg(1)->Arg(10);
+#endif
+
+// Dispatches to callbacks that each spin for the given amount of iterations,
+// either serially or split across the thread pool
+static void RunFanOut(benchmark::State &state, bool parallel) {
+  EventDispatcher dispatcher;
+
+  const size_t callback_amount = state.range(0);
+  const size_t work_per_callback = state.range(1);
+  for (size_t i = 0; i < callback_amount; ++i) {
+    dispatcher.AddCallback<int>([work_per_callback](int value) {
+      for (size_t j = 0; j < work_per_callback; ++j) {
+        benchmark::DoNotOptimize(value += static_cast<int>(j));
+      }
+    });
+  }
+  if (parallel) {
+    dispatcher.SetParallelDispatch<int>({.min_callbacks = 1});
+  }
+
+  for (auto _ : state) {
+    dispatcher.Dispatch<int>(1);
+  }
+}
+
+static void EventDispatcher_SerialFanOut(benchmark::State &state) {
+  RunFanOut(state, false);
+}
+
+static void EventDispatcher_ParallelFanOut(benchmark::State &state) {
+  RunFanOut(state, true);
+}
+
+// Compare both to find the callback amount and work per callback at which
+// parallel dispatch starts to pay off
+BENCHMARK(EventDispatcher_SerialFanOut)
+    ->ArgsProduct({{2, 8, 32}, {10, 1000, 100000}})
+    ->UseRealTime();
+BENCHMARK(EventDispatcher_ParallelFanOut)
+    ->ArgsProduct({{2, 8, 32}, {10, 1000, 100000}})
+    ->UseRealTime();
+
+// Simulates an error storm: bursts of events spread over a handful of keys
+// reaching a listener that does a fixed amount of work per event
+static void RunBurst(benchmark::State &state, EventDispatcher &dispatcher) {
+  const size_t burst_size = state.range(0);
+  const size_t key_amount = 8;
+
+  size_t listener_calls = 0;
+  dispatcher.AddCallback<size_t>([&listener_calls](size_t key) {
+    for (int i = 0; i < 100; ++i) {
+      benchmark::DoNotOptimize(key += i);
+    }
+    listener_calls++;
+  });
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < burst_size; ++i) {
+      dispatcher.Dispatch<size_t>(i % key_amount);
+    }
+    dispatcher.FlushEvents<size_t>();
+  }
+
+  state.counters["listener_calls"] = benchmark::Counter(
+      static_cast<double>(listener_calls), benchmark::Counter::kAvgIterations);
+  state.counters["suppressed"] = benchmark::Counter(
+      static_cast<double>(dispatcher.GetPolicyStats<size_t>().GetSuppressedCount()),
+      benchmark::Counter::kAvgIterations);
+}
+
+static void EventDispatcher_BurstNoPolicy(benchmark::State &state) {
+  EventDispatcher dispatcher;
+  RunBurst(state, dispatcher);
+}
+
+static void EventDispatcher_BurstCoalesced(benchmark::State &state) {
+  EventDispatcher dispatcher;
+  dispatcher.SetPolicy<size_t>({.coalesce_key = [](const size_t &key) { return key; },
+                                .batch_size = 64});
+  RunBurst(state, dispatcher);
+}
+
+static void EventDispatcher_BurstRateLimited(benchmark::State &state) {
+  EventDispatcher dispatcher;
+  dispatcher.SetPolicy<size_t>({.max_events_per_second = 1000, .burst_size = 10});
+  RunBurst(state, dispatcher);
+}
+
+BENCHMARK(EventDispatcher_BurstNoPolicy)->Arg(100)->Arg(10000);
+BENCHMARK(EventDispatcher_BurstCoalesced)->Arg(100)->Arg(10000);
+BENCHMARK(EventDispatcher_BurstRateLimited)->Arg(100)->Arg(10000);
+
 BENCHMARK_MAIN();
@@ -4,7 +4,16 @@
 
 #include "gtest/gtest.h"
 #include "event_dispatcher.h"
+#include "event_policy.h"
+#include "event_timers.h"
+#include "timer_wheel.h"
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <stdexcept>
 #include <string>
+#include <thread>
 
 using namespace event_system;
 
@@ -255,4 +264,362 @@ TEST_F(EventDispatcherTest, DispatchToMultipleCallbacks_DifferentEventTypes) {
   EXPECT_EQ(callback_count, 3);
   EXPECT_FALSE(double_callback_invoked);
   EXPECT_FALSE(string_callback_invoked);
-}
\ No newline at end of file
+}
+
+// Delayed and periodic events
+
+TEST_F(EventDispatcherTest, DispatchAfterDispatchesOnceDelayElapses) {
+  using namespace std::chrono_literals;
+  auto now = TimerWheel::Clock::now();
+  int received_value = 0;
+
+  event_dispatcher.AddCallback<int>([&received_value](int value) { received_value = value; });
+  event_dispatcher.DispatchAfter<int>(10ms, 42);
+  ASSERT_EQ(event_dispatcher.GetPendingTimerCount(), 1);
+
+  event_dispatcher.Tick(now + 5ms);
+  ASSERT_EQ(received_value, 0);
+  event_dispatcher.Tick(now + 50ms);
+  ASSERT_EQ(received_value, 42);
+  ASSERT_EQ(event_dispatcher.GetPendingTimerCount(), 0);
+}
+
+TEST_F(EventDispatcherTest, DispatchAfterMeasuresDelayFromNowAfterIdling) {
+  using namespace std::chrono_literals;
+  int received_value = 0;
+
+  event_dispatcher.AddCallback<int>([&received_value](int value) { received_value = value; });
+  // The timers have not been ticked since the dispatcher was created
+  std::this_thread::sleep_for(50ms);
+  event_dispatcher.DispatchAfter<int>(30ms, 42);
+  auto now = TimerWheel::Clock::now();
+
+  event_dispatcher.Tick(now);
+  ASSERT_EQ(received_value, 0);
+  event_dispatcher.Tick(now + 40ms);
+  ASSERT_EQ(received_value, 42);
+}
+
+TEST_F(EventDispatcherTest, DispatchAfterCopiesReferenceArguments) {
+  using namespace std::chrono_literals;
+  auto now = TimerWheel::Clock::now();
+  std::string received_message;
+
+  event_dispatcher.AddCallback<const std::string&>([&received_message](const std::string& message) { received_message = message; });
+  {
+    std::string message = "delayed";
+    event_dispatcher.DispatchAfter<const std::string&>(1ms, message);
+  }
+
+  event_dispatcher.Tick(now + 10ms);
+  ASSERT_EQ(received_message, "delayed");
+}
+
+TEST_F(EventDispatcherTest, DispatchEveryDispatchesUntilCancelled) {
+  using namespace std::chrono_literals;
+  auto now = TimerWheel::Clock::now();
+  int callback_count = 0;
+
+  event_dispatcher.AddCallback<>([&callback_count]() { callback_count++; });
+  auto timer_id = event_dispatcher.DispatchEvery<>(10ms);
+
+  event_dispatcher.Tick(now + 35ms);
+  ASSERT_EQ(callback_count, 3);
+  ASSERT_TRUE(event_dispatcher.CancelTimer(timer_id));
+  event_dispatcher.Tick(now + 100ms);
+  ASSERT_EQ(callback_count, 3);
+}
+
+TEST_F(EventDispatcherTest, TimerThreadDispatchesDelayedEvents) {
+  using namespace std::chrono_literals;
+  std::atomic<bool> callback_invoked = false;
+
+  event_dispatcher.AddCallback<>([&callback_invoked]() { callback_invoked = true; });
+  event_dispatcher.DispatchAfter<>(1ms);
+  event_dispatcher.StartTimerThread();
+
+  for (int i = 0; i < 1000 && !callback_invoked; ++i) {
+    std::this_thread::sleep_for(1ms);
+  }
+  event_dispatcher.StopTimerThread();
+  ASSERT_TRUE(callback_invoked);
+}
+
+TEST_F(EventDispatcherTest, TimerThreadRunsAlongsideOwningThread) {
+  using namespace std::chrono_literals;
+  std::atomic<int> timer_callback_count = 0;
+  int owner_callback_count = 0;
+
+  event_dispatcher.AddCallback<>([&timer_callback_count]() { timer_callback_count++; });
+  event_dispatcher.DispatchEvery<>(1ms);
+  event_dispatcher.StartTimerThread();
+
+  // Handlers are created and removed while the timer thread dispatches
+  auto deadline = TimerWheel::Clock::now() + 100ms;
+  while (TimerWheel::Clock::now() < deadline) {
+    size_t callback_id = event_dispatcher.AddCallback<int>([&owner_callback_count](int) { owner_callback_count++; });
+    event_dispatcher.Dispatch<int>(1);
+    event_dispatcher.RemoveCallback<int>(callback_id);
+    event_dispatcher.Dispatch<>();
+  }
+  event_dispatcher.StopTimerThread();
+
+  ASSERT_GT(owner_callback_count, 0);
+  ASSERT_GT(timer_callback_count, owner_callback_count);
+  ASSERT_EQ(event_dispatcher.GetHandlerCount(), 1);
+}
+
+// Event policies
+
+TEST_F(EventDispatcherTest, RateLimitPolicyDropsEventsBeyondBurst) {
+  int callback_count = 0;
+  event_dispatcher.AddCallback<int>([&callback_count](int) { callback_count++; });
+  event_dispatcher.SetPolicy<int>({.max_events_per_second = 0.001, .burst_size = 3});
+
+  for (int i = 0; i < 10; ++i) {
+    event_dispatcher.Dispatch<int>(i);
+  }
+
+  auto stats = event_dispatcher.GetPolicyStats<int>();
+  ASSERT_EQ(callback_count, 3);
+  ASSERT_EQ(stats.received, 10);
+  ASSERT_EQ(stats.delivered, 3);
+  ASSERT_EQ(stats.rate_limited, 7);
+  ASSERT_EQ(stats.GetSuppressedCount(), 7);
+}
+
+TEST_F(EventDispatcherTest, CoalescePolicyDeliversLastValuePerKey) {
+  std::vector<std::pair<int, std::string>> received;
+  event_dispatcher.AddCallback<int, std::string>([&received](int key, const std::string& value) {
+    received.emplace_back(key, value);
+  });
+  event_dispatcher.SetPolicy<int, std::string>({
+      .coalesce_key = [](const int& key, const std::string&) { return static_cast<size_t>(key); },
+      .batch_size = 10});
+
+  event_dispatcher.Dispatch<int, std::string>(1, "a");
+  event_dispatcher.Dispatch<int, std::string>(2, "b");
+  event_dispatcher.Dispatch<int, std::string>(1, "c");
+  ASSERT_TRUE(received.empty());
+
+  event_dispatcher.FlushEvents<int, std::string>();
+  std::vector<std::pair<int, std::string>> expected{{1, "c"}, {2, "b"}};
+  ASSERT_EQ(received, expected);
+  auto stats = event_dispatcher.GetPolicyStats<int, std::string>();
+  ASSERT_EQ(stats.coalesced, 1);
+}
+
+TEST_F(EventDispatcherTest, CoalescePolicyRequiresFlushTrigger) {
+  EventPolicy<int> policy{.coalesce_key = [](const int& key) { return static_cast<size_t>(key); }};
+  ASSERT_THROW(event_dispatcher.SetPolicy<int>(policy), std::invalid_argument);
+  ASSERT_EQ(event_dispatcher.GetPolicyStats<int>().received, 0);
+}
+
+TEST_F(EventDispatcherTest, RateLimitedCoalescePolicyDeliversLastValue) {
+  std::vector<std::pair<int, std::string>> received;
+  event_dispatcher.AddCallback<int, std::string>([&received](int key, const std::string& value) {
+    received.emplace_back(key, value);
+  });
+  event_dispatcher.SetPolicy<int, std::string>({
+      .coalesce_key = [](const int& key, const std::string&) { return static_cast<size_t>(key); },
+      .batch_size = 2,
+      .max_events_per_second = 0.001,
+      .burst_size = 1});
+
+  // Only one token, taken by the latest value of key 1 once the batch is full
+  event_dispatcher.Dispatch<int, std::string>(1, "a");
+  event_dispatcher.Dispatch<int, std::string>(1, "b");
+  event_dispatcher.Dispatch<int, std::string>(1, "c");
+  event_dispatcher.Dispatch<int, std::string>(2, "d");
+
+  std::vector<std::pair<int, std::string>> expected{{1, "c"}};
+  ASSERT_EQ(received, expected);
+  auto stats = event_dispatcher.GetPolicyStats<int, std::string>();
+  ASSERT_EQ(stats.received, 4);
+  ASSERT_EQ(stats.coalesced, 2);
+  ASSERT_EQ(stats.rate_limited, 1);
+  ASSERT_EQ(stats.delivered, 1);
+}
+
+TEST_F(EventDispatcherTest, BatchPolicyFlushesOnceBatchIsFull) {
+  int callback_count = 0;
+  event_dispatcher.AddCallback<int>([&callback_count](int) { callback_count++; });
+  event_dispatcher.SetPolicy<int>({.batch_size = 3});
+
+  event_dispatcher.Dispatch<int>(1);
+  event_dispatcher.Dispatch<int>(2);
+  ASSERT_EQ(callback_count, 0);
+  event_dispatcher.Dispatch<int>(3);
+  ASSERT_EQ(callback_count, 3);
+}
+
+TEST_F(EventDispatcherTest, FlushIntervalPolicyFlushesOnTick) {
+  using namespace std::chrono_literals;
+  auto now = TimerWheel::Clock::now();
+  int callback_count = 0;
+  event_dispatcher.AddCallback<int>([&callback_count](int) { callback_count++; });
+  event_dispatcher.SetPolicy<int>({.flush_interval = 10ms});
+
+  event_dispatcher.Dispatch<int>(1);
+  event_dispatcher.Dispatch<int>(2);
+  ASSERT_EQ(event_dispatcher.GetPendingTimerCount(), 1);
+  event_dispatcher.Tick(now + 5ms);
+  ASSERT_EQ(callback_count, 0);
+  event_dispatcher.Tick(now + 50ms);
+  ASSERT_EQ(callback_count, 2);
+}
+
+TEST_F(EventDispatcherTest, FlushIntervalPolicyWithTimerThread) {
+  using namespace std::chrono_literals;
+  const int event_count = 20000;
+  std::atomic<int> callback_count = 0;
+  event_dispatcher.AddCallback<int>([&callback_count](int) { callback_count++; });
+  event_dispatcher.SetPolicy<int>({.flush_interval = 1ms});
+  event_dispatcher.StartTimerThread();
+
+  // The timer thread flushes the buffer while events are being added to it
+  for (int i = 0; i < event_count; ++i) {
+    event_dispatcher.Dispatch<int>(i);
+  }
+  event_dispatcher.StopTimerThread();
+  event_dispatcher.FlushEvents<int>();
+
+  auto stats = event_dispatcher.GetPolicyStats<int>();
+  ASSERT_EQ(callback_count, event_count);
+  ASSERT_EQ(stats.received, event_count);
+  ASSERT_EQ(stats.delivered, event_count);
+}
+
+TEST_F(EventDispatcherTest, ClearPolicyFlushesBufferedEvents) {
+  int callback_count = 0;
+  event_dispatcher.AddCallback<int>([&callback_count](int) { callback_count++; });
+  event_dispatcher.SetPolicy<int>({.batch_size = 10});
+
+  event_dispatcher.Dispatch<int>(1);
+  event_dispatcher.ClearPolicy<int>();
+  ASSERT_EQ(callback_count, 1);
+  event_dispatcher.Dispatch<int>(2);
+  ASSERT_EQ(callback_count, 2);
+}
+
+// Parallel dispatch
+
+TEST_F(EventDispatcherTest, ParallelDispatchInvokesEveryCallback) {
+  std::atomic<int> callback_count = 0;
+  for (int i = 0; i < 32; ++i) {
+    event_dispatcher.AddCallback<int>([&callback_count](int value) { callback_count += value; });
+  }
+  event_dispatcher.SetParallelDispatch<int>({.min_callbacks = 2});
+
+  event_dispatcher.Dispatch<int>(1);
+  ASSERT_EQ(callback_count, 32);
+}
+
+TEST_F(EventDispatcherTest, ParallelDispatchRunsCallbacksOnOtherThreads) {
+  using namespace std::chrono_literals;
+  std::mutex thread_ids_mutex;
+  std::set<std::thread::id> thread_ids;
+  for (int i = 0; i < 4; ++i) {
+    event_dispatcher.AddCallback<>([&]() {
+      {
+        std::lock_guard lock{thread_ids_mutex};
+        thread_ids.insert(std::this_thread::get_id());
+      }
+      // Hold this callback until another thread picks up a callback as well
+      auto deadline = TimerWheel::Clock::now() + 1s;
+      while (TimerWheel::Clock::now() < deadline) {
+        {
+          std::lock_guard lock{thread_ids_mutex};
+          if (thread_ids.size() > 1) {
+            break;
+          }
+        }
+        std::this_thread::yield();
+      }
+    });
+  }
+  event_dispatcher.SetParallelDispatch<>({.min_callbacks = 2});
+
+  event_dispatcher.Dispatch<>();
+  ASSERT_GT(thread_ids.size(), 1);
+}
+
+TEST_F(EventDispatcherTest, ParallelDispatchRethrowsCallbackException) {
+  std::atomic<int> callback_count = 0;
+  for (int i = 0; i < 8; ++i) {
+    event_dispatcher.AddCallback<int>([&callback_count, i](int) {
+      callback_count++;
+      if (i == 3) {
+        throw std::runtime_error("callback failed");
+      }
+    });
+  }
+  event_dispatcher.SetParallelDispatch<int>({.min_callbacks = 2});
+
+  ASSERT_THROW(event_dispatcher.Dispatch<int>(1), std::runtime_error);
+  ASSERT_EQ(callback_count, 8);
+}
+
+TEST_F(EventDispatcherTest, ParallelCallbacksCallingDispatcherThrow) {
+  int batch_count = 0;
+  event_dispatcher.AddCallback<double>([&batch_count](double) { batch_count++; });
+  event_dispatcher.SetPolicy<double>({.batch_size = 4});
+  for (int i = 0; i < 16; ++i) {
+    event_dispatcher.AddCallback<int>([this](int) { event_dispatcher.Dispatch<double>(1.0); });
+  }
+  event_dispatcher.SetParallelDispatch<int>({.min_callbacks = 2});
+
+  ASSERT_THROW(event_dispatcher.Dispatch<int>(1), std::logic_error);
+  ASSERT_EQ(event_dispatcher.GetPolicyStats<double>().received, 0);
+
+  // Dispatcher state is left untouched
+  for (int i = 0; i < 4; ++i) {
+    event_dispatcher.Dispatch<double>(1.0);
+  }
+  ASSERT_EQ(batch_count, 4);
+}
+
+TEST_F(EventDispatcherTest, ParallelCallbacksCallingDispatcherThrowWithTimerThread) {
+  for (int i = 0; i < 16; ++i) {
+    event_dispatcher.AddCallback<int>([this](int) { event_dispatcher.RemoveCallback<int>(0); });
+  }
+  event_dispatcher.SetParallelDispatch<int>({.min_callbacks = 2});
+  event_dispatcher.StartTimerThread();
+
+  // Rejected instead of waiting on the lock held by the dispatching thread
+  ASSERT_THROW(event_dispatcher.Dispatch<int>(1), std::logic_error);
+  event_dispatcher.StopTimerThread();
+}
+
+TEST_F(EventDispatcherTest, ParallelDispatchBelowThresholdStaysOnCallingThread) {
+  auto caller_id = std::this_thread::get_id();
+  bool other_thread_used = false;
+  for (int i = 0; i < 4; ++i) {
+    event_dispatcher.AddCallback<>([&]() { other_thread_used |= std::this_thread::get_id() != caller_id; });
+  }
+  event_dispatcher.SetParallelDispatch<>({.min_callbacks = 5});
+
+  for (int i = 0; i < 100; ++i) {
+    event_dispatcher.Dispatch<>();
+  }
+  ASSERT_FALSE(other_thread_used);
+}
+
+TEST_F(EventDispatcherTest, ClearParallelDispatchGoesBackToSerial) {
+  auto caller_id = std::this_thread::get_id();
+  std::atomic<bool> other_thread_used = false;
+  for (int i = 0; i < 8; ++i) {
+    event_dispatcher.AddCallback<>([&]() {
+      if (std::this_thread::get_id() != caller_id) {
+        other_thread_used = true;
+      }
+    });
+  }
+  event_dispatcher.SetParallelDispatch<>({.min_callbacks = 1});
+  event_dispatcher.ClearParallelDispatch<>();
+
+  for (int i = 0; i < 100; ++i) {
+    event_dispatcher.Dispatch<>();
+  }
+  ASSERT_FALSE(other_thread_used);
+}
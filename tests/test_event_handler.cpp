@@ -4,6 +4,7 @@
 
 #include "event_handler.h"
 #include <gtest/gtest.h>
+#include <iostream>
 
 using namespace event_system;
 
@@ -0,0 +1,129 @@
+//
+// Created by Andres Suazo
+//
+
+#include "event_dispatcher.h"
+#include "event_tracer.h"
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace event_system;
+
+class EventTracerTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    EventTracer::Clear();
+    EventTracer::SetEnabled(true);
+  }
+
+  void TearDown() override {
+    EventTracer::SetEnabled(false);
+    EventTracer::Clear();
+  }
+
+  static size_t CountOccurrences(const std::string &text, const std::string &pattern) {
+    size_t count = 0;
+    for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
+      count++;
+    }
+    return count;
+  }
+
+  EventDispatcher event_dispatcher;
+};
+
+TEST_F(EventTracerTest, DisabledTracerDoesNotRecord) {
+  EventTracer::SetEnabled(false);
+  event_dispatcher.AddCallback<int>([](int) {});
+  event_dispatcher.Dispatch<int>(1);
+  ASSERT_EQ(EventTracer::GetRecordCount(), 0);
+}
+
+TEST_F(EventTracerTest, DispatchRecordsDispatchAndCallbackSpans) {
+  event_dispatcher.AddCallback<int>([](int) {});
+  event_dispatcher.AddCallback<int>([](int) {});
+  event_dispatcher.Dispatch<int>(1);
+
+  // Begin and end for the dispatch and each callback
+  ASSERT_EQ(EventTracer::GetRecordCount(), 6);
+}
+
+TEST_F(EventTracerTest, ChromeTraceContainsTypeNamesAndCallbackIds) {
+  size_t callback_id = event_dispatcher.AddCallback<int>([](int) {});
+  event_dispatcher.Dispatch<int>(1);
+
+  std::ostringstream output;
+  EventTracer::WriteChromeTrace(output);
+  std::string trace = output.str();
+
+  ASSERT_NE(trace.find("\"traceEvents\""), std::string::npos);
+  ASSERT_NE(trace.find("event_system::EventHandler<int>"), std::string::npos);
+  ASSERT_NE(trace.find("\"callback_id\":" + std::to_string(callback_id)), std::string::npos);
+  ASSERT_EQ(CountOccurrences(trace, "\"cat\":\"dispatch\""), 2);
+  ASSERT_EQ(CountOccurrences(trace, "\"cat\":\"callback\""), 2);
+  ASSERT_EQ(CountOccurrences(trace, "\"ph\":\"B\""), CountOccurrences(trace, "\"ph\":\"E\""));
+}
+
+TEST_F(EventTracerTest, ThreadsRecordIntoSeparateBuffers) {
+  event_dispatcher.AddCallback<>([]() {});
+  event_dispatcher.Dispatch<>();
+  std::thread([] {
+    EventDispatcher thread_dispatcher;
+    thread_dispatcher.AddCallback<>([]() {});
+    thread_dispatcher.Dispatch<>();
+  }).join();
+
+  std::ostringstream output;
+  EventTracer::WriteChromeTrace(output);
+  std::string trace = output.str();
+
+  ASSERT_EQ(EventTracer::GetRecordCount(), 8);
+  auto first_tid = trace.substr(trace.find("\"tid\":"), 8);
+  auto last_tid = trace.substr(trace.rfind("\"tid\":"), 8);
+  ASSERT_NE(first_tid, last_tid);
+}
+
+TEST_F(EventTracerTest, BuffersOfExitedThreadsAreReused) {
+  event_dispatcher.AddCallback<>([]() {});
+  event_dispatcher.Dispatch<>();
+
+  auto record_in_new_thread = [] {
+    std::thread([] {
+      EventDispatcher thread_dispatcher;
+      thread_dispatcher.AddCallback<>([]() {});
+      thread_dispatcher.Dispatch<>();
+    }).join();
+  };
+  record_in_new_thread();
+  size_t buffer_count = EventTracer::GetBufferCount();
+
+  for (int i = 0; i < 50; ++i) {
+    record_in_new_thread();
+  }
+  ASSERT_EQ(EventTracer::GetBufferCount(), buffer_count);
+  // Main thread plus the last thread, older records were dropped on reuse
+  ASSERT_EQ(EventTracer::GetRecordCount(), 8);
+}
+
+TEST_F(EventTracerTest, FullBufferKeepsMostRecentRecords) {
+  event_dispatcher.AddCallback<int>([](int) {});
+  for (size_t i = 0; i < EventTracer::kBufferCapacity; ++i) {
+    event_dispatcher.Dispatch<int>(1);
+  }
+  ASSERT_EQ(EventTracer::GetRecordCount(), EventTracer::kBufferCapacity);
+
+  std::ostringstream output;
+  EventTracer::WriteChromeTrace(output);
+  std::string trace = output.str();
+  ASSERT_EQ(CountOccurrences(trace, "\"ph\":\"B\""), CountOccurrences(trace, "\"ph\":\"E\""));
+}
+
+TEST_F(EventTracerTest, ClearDiscardsRecords) {
+  event_dispatcher.AddCallback<int>([](int) {});
+  event_dispatcher.Dispatch<int>(1);
+  ASSERT_GT(EventTracer::GetRecordCount(), 0);
+  EventTracer::Clear();
+  ASSERT_EQ(EventTracer::GetRecordCount(), 0);
+}
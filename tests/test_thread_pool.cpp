@@ -0,0 +1,78 @@
+//
+// Created by Andres Suazo
+//
+
+#include "thread_pool.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace event_system;
+
+class ThreadPoolTest : public ::testing::Test {
+protected:
+  ThreadPool pool{4};
+};
+
+TEST_F(ThreadPoolTest, ParallelForRunsEveryTaskOnce) {
+  std::vector<std::atomic<int>> run_counts(100);
+  pool.ParallelFor(run_counts.size(), [&run_counts](size_t index) { run_counts[index]++; });
+
+  for (auto &run_count : run_counts) {
+    ASSERT_EQ(run_count, 1);
+  }
+}
+
+TEST_F(ThreadPoolTest, ParallelForWithNoTasksReturns) {
+  bool task_run = false;
+  pool.ParallelFor(0, [&task_run](size_t) { task_run = true; });
+  ASSERT_FALSE(task_run);
+}
+
+TEST_F(ThreadPoolTest, ParallelForWithoutWorkersRunsOnCallingThread) {
+  ThreadPool empty_pool{0};
+  auto caller_id = std::this_thread::get_id();
+  int run_count = 0;
+
+  empty_pool.ParallelFor(10, [&](size_t) {
+    ASSERT_EQ(std::this_thread::get_id(), caller_id);
+    run_count++;
+  });
+  ASSERT_EQ(run_count, 10);
+}
+
+TEST_F(ThreadPoolTest, NestedParallelForCompletes) {
+  std::atomic<int> run_count = 0;
+  pool.ParallelFor(8, [&](size_t) {
+    pool.ParallelFor(8, [&run_count](size_t) { run_count++; });
+  });
+  ASSERT_EQ(run_count, 64);
+}
+
+TEST_F(ThreadPoolTest, ParallelForRethrowsTaskException) {
+  std::atomic<int> run_count = 0;
+  ASSERT_THROW(pool.ParallelFor(16, [&run_count](size_t index) {
+    run_count++;
+    if (index == 3) {
+      throw std::runtime_error("task failed");
+    }
+  }), std::runtime_error);
+  // Remaining tasks still run before the exception is rethrown
+  ASSERT_EQ(run_count, 16);
+}
+
+TEST_F(ThreadPoolTest, IsInTaskOnlyWhileRunningTasks) {
+  ThreadPool other_pool{1};
+  std::atomic<int> in_task_count = 0;
+  std::atomic<int> in_other_task_count = 0;
+
+  pool.ParallelFor(8, [&](size_t) {
+    in_task_count += pool.IsInTask();
+    in_other_task_count += other_pool.IsInTask();
+  });
+  ASSERT_EQ(in_task_count, 8);
+  ASSERT_EQ(in_other_task_count, 0);
+  ASSERT_FALSE(pool.IsInTask());
+}
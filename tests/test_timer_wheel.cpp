@@ -0,0 +1,154 @@
+//
+// Created by Andres Suazo
+//
+
+#include "timer_wheel.h"
+#include <gtest/gtest.h>
+
+using namespace event_system;
+using namespace std::chrono_literals;
+
+class TimerWheelTest : public ::testing::Test {
+protected:
+  TimerWheel::Clock::time_point start = TimerWheel::Clock::now();
+  TimerWheel wheel{1ms, start};
+};
+
+TEST_F(TimerWheelTest, ScheduleIncrementsPendingCount) {
+  ASSERT_EQ(wheel.GetPendingCount(), 0);
+  wheel.Schedule(10ms, [] {});
+  wheel.Schedule(20ms, [] {});
+  ASSERT_EQ(wheel.GetPendingCount(), 2);
+}
+
+TEST_F(TimerWheelTest, TaskRunsOnceDelayElapses) {
+  int run_count = 0;
+  wheel.Schedule(10ms, [&run_count] { run_count++; });
+
+  wheel.Tick(start + 9ms);
+  ASSERT_EQ(run_count, 0);
+  ASSERT_EQ(wheel.Tick(start + 10ms), 1);
+  ASSERT_EQ(run_count, 1);
+  wheel.Tick(start + 100ms);
+  ASSERT_EQ(run_count, 1);
+  ASSERT_EQ(wheel.GetPendingCount(), 0);
+}
+
+TEST_F(TimerWheelTest, DelayIsRoundedUpToWholeTicks) {
+  bool task_run = false;
+  wheel.Schedule(1500us, [&task_run] { task_run = true; });
+
+  wheel.Tick(start + 1ms);
+  ASSERT_FALSE(task_run);
+  wheel.Tick(start + 2ms);
+  ASSERT_TRUE(task_run);
+}
+
+TEST_F(TimerWheelTest, TasksRunInExpiryOrder_AcrossLevels) {
+  std::vector<int> order;
+  // Spread timers across the first three levels of the wheel
+  wheel.Schedule(70000ms, [&order] { order.push_back(3); });
+  wheel.Schedule(300ms, [&order] { order.push_back(2); });
+  wheel.Schedule(5ms, [&order] { order.push_back(1); });
+
+  wheel.Tick(start + 299ms);
+  ASSERT_EQ(order, std::vector<int>({1}));
+  wheel.Tick(start + 300ms);
+  ASSERT_EQ(order, std::vector<int>({1, 2}));
+  wheel.Tick(start + 69999ms);
+  ASSERT_EQ(order, std::vector<int>({1, 2}));
+  wheel.Tick(start + 70000ms);
+  ASSERT_EQ(order, std::vector<int>({1, 2, 3}));
+}
+
+TEST_F(TimerWheelTest, DelayBeyondWheelRangeIsNotShortened) {
+  // The wheel covers 2^32 ticks, about 49.7 days at 1ms
+  constexpr auto kDay = 24h;
+  bool task_run = false;
+  wheel.Schedule(60 * kDay, [&task_run] { task_run = true; });
+
+  wheel.Tick(start + 50 * kDay);
+  ASSERT_FALSE(task_run);
+  wheel.Tick(start + 60 * kDay - 1ms);
+  ASSERT_FALSE(task_run);
+  ASSERT_EQ(wheel.Tick(start + 60 * kDay), 1);
+  ASSERT_TRUE(task_run);
+}
+
+TEST_F(TimerWheelTest, CancelPreventsTaskFromRunning) {
+  bool task_run = false;
+  auto timer_id = wheel.Schedule(10ms, [&task_run] { task_run = true; });
+
+  ASSERT_TRUE(wheel.Cancel(timer_id));
+  ASSERT_EQ(wheel.GetPendingCount(), 0);
+  wheel.Tick(start + 20ms);
+  ASSERT_FALSE(task_run);
+}
+
+TEST_F(TimerWheelTest, CancelExpiredOrInvalidTimerFails) {
+  auto timer_id = wheel.Schedule(1ms, [] {});
+  wheel.Tick(start + 1ms);
+
+  ASSERT_FALSE(wheel.Cancel(timer_id));
+  ASSERT_FALSE(wheel.Cancel(TimerWheel::kInvalidTimerId));
+}
+
+TEST_F(TimerWheelTest, CancelStaleIdDoesNotAffectReusedTimer) {
+  auto timer_id = wheel.Schedule(1ms, [] {});
+  ASSERT_TRUE(wheel.Cancel(timer_id));
+
+  bool task_run = false;
+  wheel.Schedule(1ms, [&task_run] { task_run = true; });
+  ASSERT_FALSE(wheel.Cancel(timer_id));
+  wheel.Tick(start + 1ms);
+  ASSERT_TRUE(task_run);
+}
+
+TEST_F(TimerWheelTest, PeriodicTaskRunsUntilCancelled) {
+  int run_count = 0;
+  auto timer_id = wheel.Schedule(10ms, [&run_count] { run_count++; }, 10ms);
+
+  wheel.Tick(start + 35ms);
+  ASSERT_EQ(run_count, 3);
+  ASSERT_EQ(wheel.GetPendingCount(), 1);
+
+  ASSERT_TRUE(wheel.Cancel(timer_id));
+  wheel.Tick(start + 100ms);
+  ASSERT_EQ(run_count, 3);
+}
+
+TEST_F(TimerWheelTest, PeriodicTaskCanCancelItself) {
+  int run_count = 0;
+  TimerWheel::TimerId timer_id{};
+  timer_id = wheel.Schedule(
+      1ms,
+      [&] {
+        if (++run_count == 2) {
+          wheel.Cancel(timer_id);
+        }
+      },
+      1ms);
+
+  wheel.Tick(start + 10ms);
+  ASSERT_EQ(run_count, 2);
+  ASSERT_EQ(wheel.GetPendingCount(), 0);
+}
+
+TEST_F(TimerWheelTest, TaskCanScheduleNewTimers) {
+  int run_count = 0;
+  wheel.Schedule(1ms, [&] {
+    run_count++;
+    wheel.Schedule(1ms, [&run_count] { run_count++; });
+  });
+
+  wheel.Tick(start + 1ms);
+  ASSERT_EQ(run_count, 1);
+  wheel.Tick(start + 2ms);
+  ASSERT_EQ(run_count, 2);
+}
+
+TEST_F(TimerWheelTest, TickBeforeStartDoesNothing) {
+  wheel.Schedule(1ms, [] {});
+  ASSERT_EQ(wheel.Tick(start - 10ms), 0);
+  ASSERT_EQ(wheel.GetPendingCount(), 1);
+}